@@ -37,11 +37,11 @@
       (let* (
             (set-syntax-table easy2-mode-syntax-table)
             ;; define several category of keywords
-            (x-keywords '("vol" "vol2" "vol3" "freq" "freq2" "freq3" "form" "phase" "bal" "cirp" "ciri" "duty" "automix" "circuit" "nocircuit" "manualmix" "fadeout" "fadein" "bal"))
+            (x-keywords '("vol" "vol2" "vol3" "freq" "freq2" "freq3" "form" "phase" "bal" "cirp" "ciri" "duty" "automix" "circuit" "nocircuit" "manualmix" "fadeout" "fadein" "bal" "tap" "size" "q" "stages" "seed" "partial" "chord" "nopartials" "hz" "offset"))
             (x-types '("osc" "ramp" "ramps" "shape" "to" "seq" "randseq" ))
-            (x-constants '("right" "left" "both" "sine" "square" "tri" "saw" "tens"))
+            (x-constants '("right" "left" "both" "sine" "square" "tri" "saw" "tens" "noise" "pink" "brown" "bandnoise" "blep" "lowpass" "highpass" "bandpass" "notch"))
             (x-events '("output" "exit" "time" "addtime" "rewind" "repeat" "macro" "loop"))
-            (x-functions '("sound" "mix" "silence" "boost" "reverb"))
+            (x-functions '("sound" "mix" "silence" "boost" "reverb" "convolve" "room" "filter"))
 
             ;; generate regex string for each category of keywords
             (x-keywords-regexp (regexp-opt x-keywords 'words))
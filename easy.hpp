@@ -9,19 +9,41 @@ extern "C" {
 #include <stack>
 #include <cmath>
 #include <cassert>
+#include <algorithm>
 
 #ifndef EASY_HPP
 #define EASY_HPP 1
 
-extern double masterTime;
-extern uint32_t soundLengthX;
+#include "easy_sine.hpp"
+#include "easy_table.hpp"
+#include "easy_blep.hpp"
+#include "easy_rand.hpp"
+
+// masterTime, soundLengthX and settings are per thread so that a
+// command can be run later on another thread with the values it was
+// given (see easy_jobs.cpp)
+
+extern thread_local double masterTime;
+extern thread_local uint32_t soundLengthX;
+extern thread_local uint64_t noiseKey;     // random key for the sound's NOISE
 extern uint32_t SR;
 
+// render loops pull NumberDriver values this many samples at a time
+
+#define BLOCK_SIZE 256
+
+#define REVERB_TAPS 16     // most echoes one reverb can have
+
 //----------------------------------------------------------------------
 //
 // This class is produces a sequence of numbers that drive
 // value that vary with audio time (provided by caller
 // as the x index within the signal, as sample count.
+//
+// getBlock fills out[0..n-1] with the values for x..x+n-1. It must
+// give the same numbers as calling getValue once per sample, in order.
+// The fallback here does exactly that; the drivers below override it
+// so a render loop pays for one virtual call per block, not per sample.
 
 class NumberDriver {         // virtual class
 public:
@@ -29,12 +51,65 @@ public:
     return *this;
   }
   virtual double getValue(uint32_t x)=0;
+  virtual void getBlock(uint32_t x, uint32_t n, double *out) {
+    for (uint32_t i=0;i<n;i++) {
+      out[i]=getValue(x+i);
+    }
+  }
   virtual void init(long)=0;
   virtual ~NumberDriver();
+
+  // true if getValue never changes. Lets doSound use a kernel
+  // that reads the value once instead of every block.
+  
+  virtual bool isConstant(void) {
+    return false;
+  }
+
+  // seek(x) leaves the driver exactly as it would be after init() and
+  // a getValue() for every sample 0..x-1, so the next call can be for
+  // x. Lets a render start part way into a sound.
+  
+  virtual void seek(uint32_t x)=0;
+
+  // adds this driver, and any it is built on, to list if it keeps
+  // state from one call to the next. A driver that turns up twice
+  // for one sound is being stepped by two users, so its values
+  // depend on the order of the calls; doSound won't split those.
+
+  virtual void addState(std::vector<NumberDriver *> &list) {
+    list.push_back(this);
+  }
+
+  // clone() gives an independent copy in the same state, including
+  // copies of any drivers this one is built on.
+  
+  virtual NumberDriver * clone(void)=0;
     
   // virtual double getValue();
 };
 
+//------------------------------
+// While cloneMemo is set, cloneDriver copies each driver only once
+// and hands back the same copy when it is reached again, so drivers
+// shared by two others stay shared in the copy. The copies then
+// belong to whoever set cloneMemo rather than to their users.
+
+extern thread_local std::map<NumberDriver *,NumberDriver *> *cloneMemo;
+
+inline NumberDriver * cloneDriver(NumberDriver *nd) {
+  if (cloneMemo==NULL) {
+    return nd->clone();
+  }
+  std::map<NumberDriver *,NumberDriver *>::iterator it=cloneMemo->find(nd);
+  if (it!=cloneMemo->end()) {
+    return it->second;
+  }
+  NumberDriver *copy=nd->clone();
+  (*cloneMemo)[nd]=copy;
+  return copy;
+}
+
 //------------------------------
 
 class Value: public NumberDriver {  // derived class for a constant
@@ -54,9 +129,24 @@ class Value: public NumberDriver {  // derived class for a constant
   double getValue(uint32_t x) {
     return value;
   }
+  void getBlock(uint32_t x, uint32_t n, double *out) {
+    for (uint32_t i=0;i<n;i++) {
+      out[i]=value;
+    }
+  }
   void init(long) {
 
   }
+  bool isConstant(void) {
+    return true;
+  }
+  void seek(uint32_t x) {
+  }
+  void addState(std::vector<NumberDriver *> &list) {
+  }
+  NumberDriver * clone(void) {
+    return new Value(value);
+  }
 };
 
 //------------------------------
@@ -87,12 +177,9 @@ class Ramp: public NumberDriver {  // derived class for a ramp
     return *this;
   }
 
-  // calculate the current value on current time
-    
-  double getValue(uint32_t x) {
-    uint32_t rem;
-    double value;
-
+  // length is worked out on first use: see soundLengthX
+  
+  void checkLength(void) {
     if (length==-1) {   // is length unknown?
       length=soundLengthX;
       printf ("auto-set ramp length to %d samples SR=%d %fs\n",length,SR,1.*length/SR);
@@ -102,15 +189,133 @@ class Ramp: public NumberDriver {  // derived class for a ramp
       printf ("Unable to set length on ramp for some reason. Please manually add it.\n");
       exit(0);
     }
+  }
+
+  // calculate the current value on current time
+    
+  double getValue(uint32_t x) {
+    uint32_t rem;
+    double value;
+
+    checkLength();
     
     rem=(x-reftime)%length;  // using remainder implements repeating
     value=(targetValue-startValue)*((float)rem/length)+startValue;
     return value;
   }
+
+  void getBlock(uint32_t x, uint32_t n, double *out) {
+    checkLength();
+
+    double span=targetValue-startValue;
+    uint32_t rem=(x-reftime)%length;
+    
+    for (uint32_t i=0;i<n;i++) {
+      out[i]=span*((float)rem/length)+startValue;
+      rem++;
+      if (rem==(uint32_t) length) {   // wrap around, same as remainder
+        rem=0;
+      }
+    }
+  }
   
   void init(long) {
   }
 
+  // ramp is worked out from x alone so there is nothing to move
+  
+  void seek(uint32_t x) {
+  }
+  void addState(std::vector<NumberDriver *> &list) {
+  }
+
+  // an automatic length is settled before copying so it is only
+  // worked out (and reported) once
+
+  NumberDriver * clone(void) {
+    checkLength();
+    return new Ramp(*this);
+  }
+
+};
+
+//----------------------------------------------------------------------
+// PhaseAcc is the phase accumulator shared by SOUND and OSC.
+//
+// The phase is a 64-bit fixed point fraction of one cycle: 2^64 is
+// one full turn. Each sample adds inc and the integer overflow does
+// the wrap for us. There is no drift no matter how long the sound
+// is, and a change of frequency only changes inc so the wave stays
+// continuous (no waiting for a zero crossing).
+//
+// This has more resolution than a double would, and because integer
+// sums are exact, jumping ahead n samples gives exactly the same
+// phase as stepping n times.
+
+class PhaseAcc {
+public:
+  uint64_t phase;     // position in the current cycle
+  uint64_t inc;       // amount added per sample
+  double freq;        // frequency inc was worked out for
+
+  PhaseAcc() {
+    phase=0;
+    inc=0;
+    freq=0;
+  }
+
+  void reset(void) {
+    phase=0;
+  }
+
+  // only does the division when the frequency actually changes
+  
+  void setFreq(double f) {
+    if (f!=freq) {
+      freq=f;
+      inc=fromCycles(f/SR);
+    }
+  }
+
+  // as above but the caller supplies 1/SR, which the sound kernels
+  // have as a compile time constant
+  
+  void setFreq(double f, double invRate) {
+    if (f!=freq) {
+      freq=f;
+      inc=fromCycles(f*invRate);
+    }
+  }
+
+  void step(void) {
+    phase+=inc;
+  }
+
+  void skip(uint32_t n) {
+    phase+=inc*n;
+  }
+
+  // current position as 0..1 of a cycle, with a phase offset
+  // (also in cycles) applied
+  
+  double cycles(double offset) {
+    return toCycles(phase+fromCycles(offset));
+  }
+  
+  // conversions between a fraction of a cycle and the fixed point
+  // phase. 53 bits are used because that is what fits in a double.
+
+  static uint64_t fromCycles(double c) {
+    if (c==0) {
+      return 0;
+    }
+    c=c-floor(c);
+    return ((uint64_t) (c*9007199254740992.0))<<11;   // 2^53
+  }
+
+  static double toCycles(uint64_t p) {
+    return (p>>11)*(1./9007199254740992.0);
+  }
 };
 
 //------------------------------
@@ -123,25 +328,16 @@ public:
   double amplitude;
   double value;
   int form;
-  uint32_t refX;
+  bool blep;              // polyBLEP instead of the tables
   double freq;
   NumberDriver * freqDriver;
   NumberDriver * phaseDriver;
   NumberDriver * dutyDriver;
-  double lastfreq;
-  double lastval;
-  int32_t countX;
-  int32_t adjCountX;
-  int32_t relX;
-  int32_t splitpt;
-  int32_t endpt;
-  int32_t periodX;
-  int tridirection;
-  double sawval;
-  double trislope;
-  double sawslope;
+  PhaseAcc acc;           // where we are in the current cycle
+  uint32_t lastX;         // x of the previous call
   double oscval;
   double dutyV;
+  bool ownsDrivers;       // true for clones that made their own copies
   
   // OSCs and SOUNDs share two settings:
   // FREQ and FORM
@@ -180,8 +376,10 @@ public:
     phaseDriver->init(0);
     dutyDriver->init(0);
 
-    form=inform;
-    refX=0;
+    form=inform&~WF_BLEP;
+    blep=(inform&WF_BLEP)!=0;
+    lastX=0;
+    ownsDrivers=false;
     
 //    printf("osc: %f to %f form %d freq: %f phase:%f duty: %f\n",
 //           minValue,maxValue,
@@ -203,142 +401,103 @@ public:
   // calculate the current value on current time
     
   double getValue(uint32_t x) {
-    countX++;
-    if (countX>periodX) {
-      countX=0;
-    }
-
+    double freqV=freqDriver->getValue(x);
     double phaseV=phaseDriver->getValue(x);
-    int32_t phaseX=phaseV*periodX;
-    
-    // OSC supports SINE, SQUARE, TRI, and SAW 
-    // code will be kept as compact as possible
-
-    //-------------------------------------SINE
-
-    if ((form==WF_SINE)||(form==WF_NOISE)) {  // SINE, ignore NOISE
+    double dutyIn=0;
 
-      // phase effect is supported on SINE
-      
-      oscval=sin(2.*M_PI*freq*( ((double)(x)-double(refX)+phaseX) / SR));
+    if (form==WF_SQUARE) {              // only SQUARE makes use of duty
+      dutyIn=dutyDriver->getValue(x);
     }
+    return tick(x,freqV,phaseV,dutyIn);
+  }
 
-    //-------------------------------------SQUARE
-    
-    else if (form==WF_SQUARE) {               // SQUARE
+  // block version: freq, phase and duty are pulled a block at a time,
+  // the accumulator gives the cycle positions for the whole block and
+  // then the waveform is chosen once for the block rather than per
+  // sample.
+  
+  void getBlock(uint32_t x, uint32_t n, double *out) {
+    double freqB[BLOCK_SIZE];
+    double phaseB[BLOCK_SIZE];
+    double dutyB[BLOCK_SIZE];
 
-      // phase NumberDriver is also supposted in SQUARE
-      // and duty NumberDriver effect is also supposted in SQUARE
-      
-      dutyV=dutyDriver->getValue(x);
-      splitpt=periodX*dutyV+phaseX;   // the comparison adjusted for phase
+    while (n>0) {
+      uint32_t bn=(n>BLOCK_SIZE) ? BLOCK_SIZE : n;
       
-      if (countX<phaseX) {   // still in previous wave before true zone
-        oscval=-1;
+      freqDriver->getBlock(x,bn,freqB);
+      phaseDriver->getBlock(x,bn,phaseB);
+      for (uint32_t i=0;i<bn;i++) {
+        acc.skip(x+i-lastX);
+        lastX=x+i;
+        acc.setFreq(freqB[i]);
+        phaseB[i]=acc.cycles(phaseB[i]);    // reuse as cycle positions
       }
-      else if ((countX>=phaseX)&&(countX<splitpt)) {  // in true zone
-        oscval=1;
+      freq=freqB[bn-1];
+
+      if (form==WF_SQUARE) {
+        dutyDriver->getBlock(x,bn,dutyB);
+        if (blep) {
+          blepPulseBlock(phaseB,freqB,dutyB,out,bn);
+        }
+        else {
+          tablePulseBlock(phaseB,freqB,dutyB,out,bn);
+        }
+        dutyV=dutyB[bn-1];
       }
-      else if (countX>=splitpt) {
-        oscval=-1;                   // beyond true zone
+      else if ((form==WF_TRI)||(form==WF_SAW)) {
+        if (blep) {
+          blepBlock(form,phaseB,freqB,out,bn);
+        }
+        else {
+          tableBlock(form,phaseB,freqB,out,bn);
+        }
       }
-      else {
-        printf("osc square wave error %d",relX);
-        exit(-2);
+      else {                                  // SINE, ignore NOISE
+        sineBlock(phaseB,out,bn);
       }
-      //     printf ("countX: x %d phaseX %d relX %d duty %f, splitpt %d oscval = %f \n",
-      //        countX,
-      //        phaseX,
-      //        relX,
-      //        dutyV,
-      //        splitpt,
-      //        oscval
-      //        );
-    }
-
-    //-------------------------------------TRI
-    
-    else if (form==WF_TRI) {
       
-      // phase NumberDriver is also supported in TRI
-
-      // map countX to adjCountX while keeping it within bounds 0 to periodX
-
-      adjCountX=countX-0*periodX+phaseX;  
-      if (adjCountX<0) {
-        adjCountX=adjCountX+periodX;
+      for (uint32_t i=0;i<bn;i++) {
+        out[i]=out[i]*amplitude+midValue;
       }
-      else if (adjCountX>periodX) {
-        adjCountX=adjCountX-periodX;
-      }
-      
-      // for a zero phase TRI to start at 0, we need to have
-      // a phase bias
+      value=out[bn-1];
       
-      splitpt=periodX/2;
-      endpt=periodX;
-
-      if ((adjCountX>=0)&&(adjCountX<splitpt)) {
-        // oscval=1;
-        oscval=-1+trislope*adjCountX;
-//        printf("A -"); 
-      }
-      else if ((adjCountX>=splitpt)&&(adjCountX<=endpt)) {
-        // oscval=-1;
-        oscval=1-trislope*(adjCountX-splitpt);
-//        printf("B -"); 
-      }
-      else {
-        oscval=0;
-//        printf("C -"); 
-      }
+      x+=bn;
+      out+=bn;
+      n-=bn;
+    }
+  }
 
-//      printf("countX %d adjphase %d oscval %f trislope %f splitpt %d endpt %d\n"
-//             ,countX,adjCountX,oscval,trislope,splitpt,endpt);
+  // one sample of the oscillator, given the current freq, phase and duty
+  //
+  // the phase accumulator keeps the wave continuous through any change
+  // of frequency so, unlike the old code, freq is picked up on every
+  // sample rather than waiting for a zero crossing.
+  
+  double tick(uint32_t x, double freqV, double phaseV, double dutyIn) {
+    acc.skip(x-lastX);        // normally one sample since last call
+    lastX=x;
 
-    }
+    freq=freqV;
+    acc.setFreq(freq);
 
-    //-------------------------------------SAW
+    double cyc=acc.cycles(phaseV);   // phase is in fractions of a cycle
     
-    else if (form==WF_SAW) {
-      int32_t adjCountX;
-
-      // SAW supports phase but not duty
-      //
-      // map countX to adjCountX while keeping it within bounds 0 to periodX
+    // OSC supports SINE, SQUARE, TRI, and SAW 
+    // code will be kept as compact as possible
 
-      adjCountX=countX+phaseX;  
-      if (adjCountX<0) {
-        adjCountX=adjCountX+periodX;
-      }
-      else if (adjCountX>(int) periodX) {
-        adjCountX=adjCountX-periodX;
-      }
-      
-      oscval=-1+sawslope*adjCountX;
+    if ((form==WF_SINE)||(form>=WF_NOISE)) {  // SINE, ignore the noises
+      oscval=sineCycle(cyc);
     }
-    
-    // do we need to update frequency?
-    // just like in SOUND, we should only
-    // update freq at completion of cycles
-
-    if ((lastval<0.0) && (oscval>=0.0)) {         // end of sign wave cycle?
-      freq=freqDriver->getValue(x);
-      // printf ("osc: new  frequency %d %f\n",x,freq);
-
-      if (freq!=lastfreq) {
-        lastfreq=freq;
-        refX=x;
-        periodX=int(SR/freq); 
-        sawslope=2./periodX;
-        trislope=1./periodX;
-        countX=0;
-      }
+    else if (form==WF_SQUARE) {               // SQUARE
+      dutyV=dutyIn;
+      oscval=blep ? blepPulse(cyc,freq,dutyV) : tablePulse(cyc,freq,dutyV);
     }
-    else {
-      // printf ("osc: not zero crossing %d %f %f\n",x,lastval,oscval);
+    else if (form==WF_TRI) {
+      oscval=blep ? blepTri(cyc,freq) : tableTri(cyc,freq);
+    }
+    else if (form==WF_SAW) {                  // SAW supports phase but not duty
+      oscval=blep ? blepSaw(cyc,freq) : tableSaw(cyc,freq);
     }
-    lastval=oscval;
     
     value=oscval*amplitude+midValue;
 
@@ -358,13 +517,68 @@ public:
     freq=freqDriver->getValue(0);
     dutyDriver->init(0);
 
-    lastfreq=freq;
-    refX=0;
-    countX=0;
-    periodX=int(SR/freq); 
-    sawslope=2./periodX;
-    trislope=4./periodX;
-    sawval=0;
+    acc.reset();
+    lastX=0;
+  }
+
+  // The phase at x is the sum of the increments for samples 0..x-1.
+  // With a fixed freq that is just inc*x (integer, so exact). A
+  // driven freq has to be replayed from the start; the sum is still
+  // exact because it is done in integers the same way as tick().
+  
+  void seek(uint32_t x) {
+    phaseDriver->seek(x);
+    dutyDriver->seek(x);
+
+    acc.reset();
+    lastX=x;
+
+    if (x==0) {
+      freqDriver->seek(0);
+    }
+    else if (freqDriver->isConstant()) {
+      freq=freqDriver->getValue(0);
+      acc.setFreq(freq);
+      acc.phase=acc.inc*x;
+    }
+    else {
+      double freqB[BLOCK_SIZE];
+
+      freqDriver->seek(0);
+      for (uint32_t bx=0;bx<x;bx+=BLOCK_SIZE) {
+        uint32_t bn=(x-bx>BLOCK_SIZE) ? BLOCK_SIZE : x-bx;
+        freqDriver->getBlock(bx,bn,freqB);
+        for (uint32_t i=0;i<bn;i++) {
+          acc.setFreq(freqB[i]);
+          acc.step();
+        }
+      }
+      freq=acc.freq;
+    }
+  }
+
+  void addState(std::vector<NumberDriver *> &list) {
+    list.push_back(this);
+    freqDriver->addState(list);
+    phaseDriver->addState(list);
+    dutyDriver->addState(list);
+  }
+
+  NumberDriver * clone(void) {
+    Osc *copy=new Osc(*this);
+    copy->freqDriver=cloneDriver(freqDriver);
+    copy->phaseDriver=cloneDriver(phaseDriver);
+    copy->dutyDriver=cloneDriver(dutyDriver);
+    copy->ownsDrivers=(cloneMemo==NULL);
+    return copy;
+  }
+
+  ~Osc() {
+    if (ownsDrivers) {
+      delete freqDriver;
+      delete phaseDriver;
+      delete dutyDriver;
+    }
   }
 
 };
@@ -377,6 +591,9 @@ public:
   long step=0;
   std::vector<double> entV;
   std::vector<uint32_t> entT;
+  std::vector<uint64_t> entS;   // sample each entry starts on (for seek)
+  uint64_t loopLen;             // samples per loop, 0 if it doesn't loop
+  uint64_t endS;                // end of the last entry if it doesn't loop
   double curval;
   uint32_t curtime;
   uint32_t countX=0;
@@ -392,6 +609,27 @@ public:
     entT=times;
     curval=entV[0];
     curtime=entT[0];
+    findStarts();
+  }
+
+  // Each entry lasts its time +1 samples (the count has to go past
+  // the time). An entry with time 0 sends the sequence back to the
+  // start; otherwise the last value holds once the list runs out.
+
+  void findStarts(void) {
+    uint64_t t=0;
+    
+    entS.clear();
+    loopLen=0;
+    for (size_t j=0;j<entV.size();j++) {
+      entS.push_back(t);
+      t+=entT[j]+1;
+      if (entT[j]==0) {
+        loopLen=t;
+        break;
+      }
+    }
+    endS=t;
   }
 
   double getValue(uint32_t x) {
@@ -405,24 +643,33 @@ public:
       countX=0;
       step++;
       // printf("seq entries: %d\n",entV.size());
-      if (step<=(long) entV.size()) {   // is there another value?
-        
-        if (curtime==0) {          // loop around if last time is zero
-          // loop when a zero time value seen
 
-          step=0;
-        }
+      if (curtime==0) {          // loop around if last time is zero
+        // loop when a zero time value seen
+
+        step=0;
+      }
 
+      if (step<(long) entV.size()) {   // is there another value?
         curval=entV[step];
         curtime=entT[step];
         // printf("seq entry: %d %f %d\n",step,curval,curtime);
       }
       else {
-        // do nothing: we're done here
+        step=entV.size();  // do nothing: we're done here
       }
     }
     return curval;
   }
+
+  // seq has to count its way through every sample so the block
+  // version just does that without going through the vtable
+  
+  void getBlock(uint32_t x, uint32_t n, double *out) {
+    for (uint32_t i=0;i<n;i++) {
+      out[i]=Seq::getValue(x+i);
+    }
+  }
     
   void setValue(double value) {
   }
@@ -433,7 +680,36 @@ public:
   }
 
   void init(long) {
-    
+    seek(0);
+  }
+
+  // find the entry with a binary search over the start times
+  
+  void seek(uint32_t x) {
+    uint64_t p=x;
+
+    if (loopLen>0) {
+      p=p%loopLen;
+    }
+    lastX=x;
+
+    if (p>=endS) {                 // ran out, last value holds
+      step=entV.size();
+      curval=entV.back();
+      curtime=entT.back();
+      countX=0;
+      return;
+    }
+
+    long j=std::upper_bound(entS.begin(),entS.end(),p)-entS.begin()-1;
+    step=j;
+    curval=entV[j];
+    curtime=entT[j];
+    countX=p-entS[j];
+  }
+  
+  NumberDriver * clone(void) {
+    return new Seq(*this);
   }
 
 };
@@ -474,8 +750,14 @@ public:
     // a freq it will jump by the period of the waveform
     
     uint32_t addX=x-lastX;  
-    countX+=addX;
     lastX=x;
+    return advance(addX);
+  }
+
+  // move on addX samples and work out the new value
+  
+  double advance(uint32_t addX) {
+    countX+=addX;
         
     if (countX>=tarTimeX) {          // time for next value??
       step++;
@@ -495,7 +777,7 @@ public:
     }
 
     if ((entT[step]-countX)==0) {  // protect against divide by zero
-      curval=entT[step];
+      curval=entV[step];
     }
     else {
 
@@ -509,6 +791,14 @@ public:
     
     return curval;
   }
+
+  // same stepping as getValue, one block at a time
+  
+  void getBlock(uint32_t x, uint32_t n, double *out) {
+    for (uint32_t i=0;i<n;i++) {
+      out[i]=Ramps::getValue(x+i);
+    }
+  }
     
   void setValue(double value) {
     curval=value;
@@ -522,10 +812,49 @@ public:
   }
 
   void init(long) {
+    step=0;
+    countX=0;
+    lastX=0;
     lastval=entV[0];
     tarTimeX=entT[0];
   }
 
+  // Each value depends on the one before so there is no closed
+  // form; seek replays from the start. Once two loops in a row
+  // start in the same state every later loop is identical, so whole
+  // loops are skipped from then on.
+  
+  void seek(uint32_t x) {
+    init(0);
+    if (x==0) {
+      return;
+    }
+    advance(0);                   // sample 0
+
+    bool haveStart=false;
+    double startVal=0;            // lastval at the previous loop start
+    uint32_t startK=0;            // and where it was
+    
+    for (uint32_t k=1;k<x;k++) {
+      advance(1);
+      if (countX==0) {            // just looped
+        if (haveStart && (lastval==startVal)) {
+          uint32_t cycle=k-startK;
+          uint32_t left=x-1-k;
+          k+=left-left%cycle;
+        }
+        haveStart=true;
+        startVal=lastval;
+        startK=k;
+      }
+    }
+    lastX=x-1;
+  }
+  
+  NumberDriver * clone(void) {
+    return new Ramps(*this);
+  }
+
 };
 
 
@@ -537,10 +866,12 @@ public:
   double value;
   double minValue;
   double maxValue;
-  double countdown;
   double amplitude;
-  uint32_t updateX;
+  uint32_t periodX;
   double updatePeriod;
+  uint64_t key;          // this randseq's stream (see easy_rand.hpp)
+  uint64_t origin;       // key for the sound it is being used in
+  uint32_t held;         // which period value is for
 
   RandSeq(double minV, double maxV, double update) {
     if (minV>maxV) {
@@ -553,10 +884,12 @@ public:
     }
     amplitude=maxValue-minValue;
     updatePeriod=update;
-    updateX=int(update*SR);
+    periodX=int(update*SR);
+    key=newRandKey();
 
     //printf("new random sequence: %f %f %f\n",minV,maxV,update);
 
+    init(0);
     value=getValue(0);  // get an initial value
   }
     
@@ -567,23 +900,49 @@ public:
     value=right.value;
     return *this;
   }
+
+  // sample 0 has a value of its own, held until a new one is drawn
+  // at every period+1. Each value comes straight from the period's
+  // number, so it doesn't matter what was asked for before.
   
   double getValue(uint32_t x) {
-    if (x>updateX) {
-      updateX+=int(updatePeriod*SR);
-      double randvalue=((float) rand()/(float) (RAND_MAX));
-      value=randvalue*amplitude+minValue;               // update value
-      //printf("new random value: %d %f\n",x,value);
+    uint32_t period=x;
+    if (periodX>0) {
+      period=(x==0) ? 0 : (x-1)/periodX;
     }
-    else if (x==0) {
-      double randvalue=((float) rand()/(float) (RAND_MAX));
-      value=randvalue*amplitude+minValue;               // update value
+    if (period!=held) {
+      held=period;
+      value=randUnit(origin,period)*amplitude+minValue;
+      //printf("new random value: %d %f\n",x,value);
     }
-    
     return value;
   }
 
-  void init(long) { }
+  // random values only change every updatePeriod so this is cheap
+  
+  void getBlock(uint32_t x, uint32_t n, double *out) {
+    for (uint32_t i=0;i<n;i++) {
+      out[i]=RandSeq::getValue(x+i);
+    }
+  }
+
+  // each sound (at its place in the output) gets different values,
+  // rather than every use of the randseq playing the same ones
+
+  void init(long) {
+    origin=randBits(key,(uint64_t) (masterTime*SR+.5));
+    held=UINT32_MAX;
+  }
+
+  void seek(uint32_t x) {
+  }
+
+  void addState(std::vector<NumberDriver *> &list) {
+  }
+
+  NumberDriver * clone(void) {
+    return new RandSeq(*this);
+  }
 
 
 };
@@ -606,26 +965,12 @@ class Shape: public NumberDriver {    // sequencer
 public:
   int preset;
   long length=-1;
-  long step=0;
-  long steps;
   std::vector<double> entV;
   std::vector<double> entT;
-  std::vector<double> entTX;
-  double curval;
-  uint32_t curtime;
-  uint32_t countX=0;   // counter for whole shape length
-  uint32_t stepX=0;    // counter within one step
-  uint32_t lenStepX;
-  uint32_t ta;
-  uint32_t tb;
-  double va;
-  double vb;
+  std::vector<uint32_t> entTX;   // entT in samples, always increasing
   uint32_t lenX;
   
   Shape() {
-    step=1;
-    countX=0;
-    stepX=0;
   }
 
   Shape(int dtype, double len) {
@@ -654,56 +999,34 @@ public:
     loadTable();
   }
 
-  // by the time we get to getValue, everything must be worked out and ready to calculate
+  // The shape is a straight line between each pair of points and
+  // repeats every lenX samples, so the value comes straight from x:
+  // find the pair either side of it and slope between them.
   
   double getValue(uint32_t x) {
-               // X is counter within whole sound
-    countX++;  // countX is counter for whole shape
-    stepX++;   // stepX is counter for this step
+    uint32_t posX=x%lenX;    // position within the shape
 
-    // its a slope calculation of value between points
+    // first point after posX. entTX[0] is always 0 so j is at least 1
     
-    curval=vb+(va-vb)*stepX/double(lenStepX);
-
-//    printf("DEBUG shape: vb %f va %f  ratio: %f  stepX: %d  bottom: %d\n",vb,va,stepX/(double(lenStepX)),stepX,lenStepX);
-    
-
-    // printf("%d %d %d %d curval %f = vb %f + (va %f -vb %f )* x %d / (%d)\n",x,countX,stepX,lenStepX,curval,vb,va,vb, stepX,lenStepX);
-
-
-    if (countX>=lenX) {
-      step=1;
-      countX=0;     // reset both counters
-      stepX=0;
-
-      // restart back at beginning of steps
-      
-      ta=entTX[step];      // time after (at end of step)
-      tb=entTX[step-1];    // time before (at end of step)
-      lenStepX=ta-tb;
+    size_t j=std::upper_bound(entTX.begin(),entTX.end(),posX)-entTX.begin();
+    if (j>=entTX.size()) {
+      return entV.back();
     }
 
-    // have we reached the end of this step?
-    
-    else if (stepX>lenStepX) {
-      step++;
-      stepX=0;   // reset counter
+    uint32_t tb=entTX[j-1];      // time before
+    uint32_t ta=entTX[j];        // time after
+    double vb=entV[j-1];         // value before
+    double va=entV[j];           // value target
 
-      if (step<(long) entTX.size()) {
+    // printf("%d %d curval = vb %f + (va %f -vb %f )* (%d-%d) / (%d)\n",x,posX,vb,va,vb,posX,tb,ta-tb);
 
-        // simply go to next step
-        
-        ta=entTX[step];      // time after (at end of step)
-        tb=entTX[step-1];    // time before (at end of step)
-        lenStepX=ta-tb;
-        va=entV[step];      // value target (after step)
-        vb=entV[step-1];    // value before (before step)
-      }
-    }
-    else {
-      // otherwise just freeze output value
+    return vb+(va-vb)*(posX-tb)/double(ta-tb);
+  }
+
+  void getBlock(uint32_t x, uint32_t n, double *out) {
+    for (uint32_t i=0;i<n;i++) {
+      out[i]=Shape::getValue(x+i);
     }
-    return curval;
   }
     
   void setValue(double value) {
@@ -713,7 +1036,34 @@ public:
     length=right.length;
     return *this;
   }
+
+  // worked out from x alone
+  
+  void seek(uint32_t x) {
+  }
+  void addState(std::vector<NumberDriver *> &list) {
+  }
   
+  NumberDriver * clone(void) {
+    return new Shape(*this);
+  }
+  
+};
+
+//------------------------------------------------------------------------
+// one partial of the additive bank: a sine at freq times the sound's
+// freq (or at freq Hz), at amp. freq2/vol2 and freq3/vol3 are two
+// partials in Hz; the partial command adds more.
+
+#define BANK_PARTIALS 64           // most partials on one sound
+#define BANK_VOICES 8              // most notes in a chord
+
+struct Partial {
+  NumberDriver *freq;
+  NumberDriver *amp;
+  bool hz;                   // freq is in Hz, not a multiple
+  double offset;             // phase at the start, in cycles
+  const char *name;          // for errors
 };
 
 //------------------------------------------------------------------------
@@ -743,6 +1093,8 @@ struct settings_struct {
   bool circuit;                // whether to enable circuit effects
   NumberDriver *cirp;          // proportional term for circuit model
   NumberDriver *ciri;          // integral term for circuit model
+  std::vector<Partial> partials;
+  std::vector<double> chord;   // multiples of freq the bank plays at
   
 };
 
@@ -772,6 +1124,9 @@ struct settings_struct_stacked {
   bool circuit;                // whether to enable circuit effects
   NumberDriver *cirp;          // proportional term for circuit model
   NumberDriver *ciri;          // integral term for circuit model
+  std::vector<Partial> partials;
+  std::vector<double> chord;   // multiples of freq the bank plays at
+  bool newPartials;            // this line has given partials
   
 };
 
@@ -0,0 +1,151 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// blep
+//
+// The polyBLEP shapes described in easy_blep.hpp.
+//
+// t is the position in the cycle measured from an edge (0..1) and dt
+// the fraction of a cycle one sample covers. The corrections are
+// zero except within dt of the edge, on either side of it.
+//
+//   blep   added to an upward step of 2 (-1 to +1)
+//   blamp  added to a corner where the slope goes up by 2 per sample
+//
+//----------------------------------------------------------------------
+
+extern "C" {
+  #include "easy_code.h"
+}
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "easy_blep.hpp"
+
+extern uint32_t SR;
+
+//----------------------------------------------------------------------
+
+static inline double blep(double t, double dt) {
+  if (t<dt) {                      // just after the edge
+    t=t/dt;
+    return t+t-t*t-1.;
+  }
+  if (t>1.-dt) {                   // just before it
+    t=(t-1.)/dt;
+    return t*t+t+t+1.;
+  }
+  return 0.;
+}
+
+static inline double blamp(double t, double dt) {
+  if (t<dt) {
+    t=t/dt-1.;
+    return -t*t*t/3.;
+  }
+  if (t>1.-dt) {
+    t=(t-1.)/dt+1.;
+    return t*t*t/3.;
+  }
+  return 0.;
+}
+
+// fraction of a cycle per sample. Past half, the corrections either
+// side of an edge would overlap.
+
+static inline double stepOf(double freq) {
+  double dt=fabs(freq)/SR;
+  return (dt>.5) ? .5 : dt;
+}
+
+static inline double wrap(double cyc) {
+  return cyc-floor(cyc);
+}
+
+static inline double clampDuty(double duty) {
+  if (duty<0.) {
+    return 0.;
+  }
+  if (duty>1.) {
+    return 1.;
+  }
+  return duty;
+}
+
+//----------------------------------------------------------------------
+// the shapes, the same as the tables give:
+//
+//   SAW    -1 rising to +1, dropping back at 0
+//   TRI    -1 at 0, +1 at .5
+//   pulse  +1 for the duty part of the cycle, -1 for the rest (OSC)
+//   bipolar  -1 for the first half of duty, +1 for the second, 0
+//            after that (SOUND's square)
+
+static inline double sawAt(double p, double dt) {
+  return 2.*p-1.-blep(p,dt);
+}
+
+static inline double triAt(double p, double dt) {
+  double v=(p<.5) ? 4.*p-1. : 3.-4.*p;
+  return v+4.*dt*(blamp(p,dt)-blamp(wrap(p-.5),dt));
+}
+
+static inline double pulseAt(double p, double dt, double duty) {
+  double v=(p<duty) ? 1. : -1.;
+  return v+blep(p,dt)-blep(wrap(p-duty),dt);
+}
+
+static inline double bipolarAt(double p, double dt, double duty) {
+  double half=duty/2.;
+  double v;
+
+  if (p<half) {
+    v=-1.;
+  }
+  else if (p<duty) {
+    v=1.;
+  }
+  else {
+    v=0.;
+  }
+  return v-.5*blep(p,dt)+blep(wrap(p-half),dt)-.5*blep(wrap(p-duty),dt);
+}
+
+//----------------------------------------------------------------------
+
+double blepSaw(double cyc, double freq) {
+  return sawAt(wrap(cyc),stepOf(freq));
+}
+
+double blepTri(double cyc, double freq) {
+  return triAt(wrap(cyc),stepOf(freq));
+}
+
+double blepPulse(double cyc, double freq, double duty) {
+  return pulseAt(wrap(cyc),stepOf(freq),clampDuty(duty));
+}
+
+void blepBlock(int form, const double *cyc, const double *freq, double *out, uint32_t n) {
+  if (form==WF_SAW) {
+    for (uint32_t i=0;i<n;i++) {
+      out[i]=sawAt(wrap(cyc[i]),stepOf(freq[i]));
+    }
+  }
+  else {                               // WF_TRI
+    for (uint32_t i=0;i<n;i++) {
+      out[i]=triAt(wrap(cyc[i]),stepOf(freq[i]));
+    }
+  }
+}
+
+void blepPulseBlock(const double *cyc, const double *freq, const double *duty, double *out, uint32_t n) {
+  for (uint32_t i=0;i<n;i++) {
+    out[i]=pulseAt(wrap(cyc[i]),stepOf(freq[i]),clampDuty(duty[i]));
+  }
+}
+
+void blepBipolarBlock(const double *cyc, const double *freq, const double *duty, double *out, uint32_t n) {
+  for (uint32_t i=0;i<n;i++) {
+    out[i]=bipolarAt(wrap(cyc[i]),stepOf(freq[i]),clampDuty(duty[i]));
+  }
+}
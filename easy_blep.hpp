@@ -0,0 +1,37 @@
+//----------------------------------------------------------------------
+// PolyBLEP SAW, TRI and the pulse shapes.
+//
+// An alternative to the wavetables in easy_table.hpp, picked per form
+// with blep after it (square blep, saw blep, tri blep). The shape is
+// drawn straight from the formula and then, in the one sample either
+// side of each jump, a short polynomial is added that turns the hard
+// step into a band-limited one (Välimäki and Huovilainen's polyBLEP).
+// TRI has corners rather than jumps and gets the integral of the
+// same polynomial (polyBLAMP).
+//
+// Away from the edges the cost is the formula itself. The tables stay
+// the default: they are cleaner right up to Nyquist, while polyBLEP
+// leaves some aliasing at the top but keeps the full bandwidth at
+// every frequency instead of stepping down an octave at a time.
+//
+// The shapes and the functions match their table versions one for
+// one, so either can be used in the same place.
+
+#ifndef EASY_BLEP_HPP
+#define EASY_BLEP_HPP 1
+
+#include <stdint.h>
+
+// single values, for OSC getValue
+
+double blepSaw(double cyc, double freq);
+double blepTri(double cyc, double freq);
+double blepPulse(double cyc, double freq, double duty);
+
+// whole blocks, as tableBlock, tablePulseBlock and tableBipolarBlock
+
+void blepBlock(int form, const double *cyc, const double *freq, double *out, uint32_t n);
+void blepPulseBlock(const double *cyc, const double *freq, const double *duty, double *out, uint32_t n);
+void blepBipolarBlock(const double *cyc, const double *freq, const double *duty, double *out, uint32_t n);
+
+#endif
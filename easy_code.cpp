@@ -115,9 +115,18 @@ extern "C" {
 #include "easy.hpp"
 #include "easy_wav.hpp"
 #include "easy_node.hpp"
+#include "easy_sine.hpp"
+#include "easy_jobs.hpp"
+#include "easy_fft.hpp"
+#include "easy_filter.hpp"
 
 extern "C" {
   extern int flag48;
+  extern int flagJobs;
+  extern int flagGraph;
+  extern int flagStream;
+  extern int flagMap;
+  extern int flagInterleave;
    FILE * copyyyin;
   const char * copyinfile;
   const char * originalinfile;
@@ -147,34 +156,42 @@ node * GetLeft (node * center);
 node * GetRight (node * center);
 const char * debug_type (int dtype);
 void scanForAssignments(void);
+void scanForClauseWords(void);
 void midi_symbols(void);
 void doPreset (const char * str, float number);
 
 // these are over in easy_sound...
 
-void doSound(double, bool);
+void doSound(double);
 void doMix(double);
 void doSilence(double);
 void doBoost(double, NumberDriver *);
-void doReverb (double length, NumberDriver *amt, NumberDriver *del);
+void doReverb (double length, NumberDriver *amt, int taps, NumberDriver **del, double *gain);
+void doConvolve (double length, NumberDriver *amt, const char *irFile, double decay);
+void doRoom (double length, NumberDriver *amt, NumberDriver *decay, NumberDriver *size);
+void doFilter (double length, int type, int stages, NumberDriver *cutoff, NumberDriver *q);
+void doCircuit (double length);
 
 // GLOBALS...
 
 char * outputFile=NULL;
 node * copyNodes (node * n);
-double masterTime=0;
+thread_local double masterTime=0;
 WaveWriter *wavout;
 long defaultFormat = 44100;             // 16bit, 44kHz
 const char * defaultFileout = "output.wav";   // because people will forget
 uint32_t SR=999999;                      // sample rate
-uint32_t soundLengthX;                  // length of current sound or boost in samples
+thread_local uint32_t soundLengthX;     // length of current sound or boost in samples
+thread_local uint64_t noiseKey;         // random key of current sound
+uint64_t randSeed;                      // see easy_rand.hpp
+static uint64_t randStreams=0;          // streams handed out since the seed
 
 Ramp *unusedRamp=NULL;                  // temp, until I figure out what to do with these
 Osc *unusedOsc=NULL;                    // temp, until I figure out what to do with these
 Ramps *unusedRamps=NULL;
 RandSeq *unusedRand=NULL;
 
-stack<double> rewindHistory;            // remembers previous times of sounds
+vector<double> rewindHistory;           // remembers previous times of sounds
 bool updateDefaults=true;               // flag for updating default settings
 
 //--------------------------
@@ -242,12 +259,14 @@ stack<subStackItem> substack;
 
 NumberDriver::~NumberDriver() {}
 
+thread_local std::map<NumberDriver *,NumberDriver *> *cloneMemo=NULL;
+
 
 //======================================================================
 
 
 struct settings_struct defaults;
-struct settings_struct_stacked settings;
+thread_local struct settings_struct_stacked settings;
 
 //--------------------------------
   
@@ -693,6 +712,10 @@ void Shape::loadTable(void) {
       entV=rev2_entV;
       entT=rev2_entT;
     }
+    else if (preset==SH_REV3) {
+      entV=rev3_entV;
+      entT=rev3_entT;
+    }
     else if (preset==SH_WEDGE1) {
       entV=wedge1_entV;
       entT=wedge1_entT;
@@ -716,23 +739,31 @@ void Shape::loadTable(void) {
     entT.push_back(1.0);       // will scale to length
 
     assert(entT.size()==entV.size());
-    steps=entT.size();
     lenX=1.*length;  // convert times scaled to length
+
+    // convert times to samples and scaled to length. getValue needs
+    // them in order; if a table steps back in time, the value before
+    // it is held to the end instead (which is what the old stepping
+    // code ended up doing).
+
+    std::vector<double> values;
+    entTX.clear();
     
-    for(int i=0; i<steps; i++) {
+    for(size_t i=0; i<entT.size(); i++) {
       double value=entT.at(i);  // annoying: C++ doesn't seem to do the right thing without this
       uint32_t entTXval=value*length;
-      entTX.push_back(entTXval);  // convert times to samples and scaled to length
+
+      if ((i>0) && (entTXval<entTX.back())) {
+        entTX.push_back(lenX);
+        values.push_back(values.back());
+        break;
+      }
+      entTX.push_back(entTXval);
+      values.push_back(entV[i]);
     }
-    
-    va=entV[1];
-    vb=entV[0];
-    ta=entTX[1];
-    tb=entTX[0];
-    
-    step=0;
+    entV=values;
 
-    // printf("initial shape (step %ld): %f -> %f   %d -> %d\n",step,vb,va,tb,ta);
+    // printf("initial shape: %d points over %d samples\n",entTX.size(),lenX);
 }
 
 //--------------------------
@@ -767,6 +798,13 @@ void listVariables(void) {
 
 void syntaxError (node * cur,const char * str) {
   printf("%sERROR - line number %d - %s\n%s",RED,lineNumber,str,WHT);
+
+  // a file streamed out so far (-s) would look finished but isn't
+  
+  if ((wavout!=NULL) && wavout->isOpen()) {
+    printf("%sRemoving the partly written %s\n%s",RED,outputFile,WHT);
+    wavout->streamAbandon(outputFile);
+  }
   exit(1);
 }
 
@@ -980,6 +1018,9 @@ bool swapVariables(void) {
 // The information for the assignment is now all in the = node (start).
 
 void doAssignment (node * ass) {
+  if (ass->str==NULL) {
+    syntaxError(ass,"Missing left hand side of assignment.\n");
+  }
   printf("    debug: assignment varname is %s\n",ass->str);
   // displayForward();
 
@@ -1091,25 +1132,36 @@ void init (void) {
   defaults.cirp=new Value(.4);
   defaults.ciri=new Value(.2);
 
-  rewindHistory.push(masterTime);  // start history at time 0.
+  rewindHistory.push_back(masterTime);  // start history at time 0.
 
   
-  srand(time(NULL));  // init random number generation
+  randSeed=time(NULL)%SEED_MAX;  // init random number generation
+  printf("%sRandom seed %lu (seed %lu repeats this render).\n%s",CYN,(unsigned long) randSeed,(unsigned long) randSeed,WHT);
+
+  sineInit();         // pick the fastest sine kernel for this CPU
+  printf("%sUsing %s sine kernel.\n%s",CYN,sineKernelName(),WHT);
 
+  int layout=flagInterleave ? LAYOUT_INTERLEAVED : LAYOUT_PLANAR;
 
   if (flag48!=0) {
-    wavout=new WaveWriter(48000*60*60*2.5,48000);
+    wavout=new WaveWriter(48000*60*60*2.5,48000,layout);
     SR=48000;
     printf("%sOutput format is 48kHz, 24 bit .wav\n%s",MAG,WHT);
   }
   else {
-    wavout=new WaveWriter(44100*60*60*2.5,44100);
+    wavout=new WaveWriter(44100*60*60*2.5,44100,layout);
     SR=44100;
     printf("%sOutput format is 44.1kHz, 16 bit .wav\n%s",MAG,WHT);
   }
 
   printf("%sLoading preset symbols.\n%s",CYN,WHT);
   midi_symbols();
+
+  wavout->mapped=(flagMap!=0);
+
+  if (flagGraph) {
+    jobsStart(flagJobs);
+  }
 }
 
 //--------------------------------------------------
@@ -1137,6 +1189,9 @@ void copySettings (void) {
   settings.circuit=defaults.circuit;
   settings.ciri=defaults.ciri;
   settings.cirp=defaults.cirp;
+  settings.partials=defaults.partials;
+  settings.chord=defaults.chord;
+  settings.newPartials=false;
 }
 
 //---------------------------------------------------
@@ -1171,6 +1226,8 @@ void copySettingsToDefaults (void) {
   defaults.circuit=settings.circuit;
   defaults.ciri=settings.ciri;
   defaults.cirp=settings.cirp;
+  defaults.partials=settings.partials;
+  defaults.chord=settings.chord;
 
   // shape is never copied back
 }
@@ -1219,6 +1276,19 @@ int getFormStack (void) {
   return form;
 }
 
+// blep straight after square, saw or tri asks for the polyBLEP shape
+// instead of the wavetable (see easy_blep.hpp). It rides along with
+// the form as WF_BLEP added on.
+
+int blepRight (node * n) {
+  node * right=GetRight(n);
+
+  if ((right!=NULL) && (right->dtype==BLEP)) {
+    return WF_BLEP;
+  }
+  return 0;
+}
+
 //----------------------------------------------------------------------
 // CheckRight
 //
@@ -1459,6 +1529,14 @@ double NumberRight (node * n) {
 }
 
 
+//----------------------------------------------------------------------
+// every randseq and every sound gets a stream of its own. They are
+// numbered in script order so the same seed gives the same render.
+
+uint64_t newRandKey(void) {
+  return randBits(randSeed,randStreams++);
+}
+
 //============================================================================
 // This is essentially the main loop which is called once per line. The line
 // is a linked list of nodes at this point.
@@ -1503,6 +1581,7 @@ void processCommands (void) {
 
     // printf("  before swapVariables... \n");
 
+    scanForClauseWords();      // clause words outside their clause are names
     scanForAssignments();      // pre-process any assignments
 
     // displayForward();
@@ -1601,7 +1680,7 @@ void lookForRepeat() {
 //----------------------------------------------------------------------
 // do any tidy up work and write the output file
 
-void finish(void) {
+static void pickOutputFile(void) {
 
   if (outputFile==NULL) {
 
@@ -1621,12 +1700,148 @@ void finish(void) {
 
     printf("%sOutput automatically set to %s %s\n",CYN,outputFile,WHT);
   }
+}
+
+void finish(void) {
+  pickOutputFile();
+  
+  jobsWait();          // anything still rendering
   
   printf ("%sWriting file %s%s\n",CYN,outputFile,WHT);
   
   wavout->writeFile(outputFile);
   doMp3(outputFile,originalinfile);
 }
+
+//----------------------------------------------------------------------
+// stream mode (-s N)
+//
+// The output file is written while the script runs. Audio more than
+// N seconds behind both the current time and the starts of the last
+// STREAM_REWIND commands (where rewind 1 to rewind STREAM_REWIND go
+// back to) is taken as finished, written out and freed. Reverb only
+// writes ahead of where it reads so it doesn't hold anything back. A
+// command that starts in the part already written is an error, and
+// like any other error it removes the partly written file.
+
+static double streamedTime=0;          // everything before this is out
+
+static void streamCheck(node * cur) {
+  if ((flagStream>0) && (masterTime<streamedTime)) {
+    printf("%s  -s %d: time %f was already written out (up to %f)\n%s",RED,flagStream,masterTime,streamedTime,WHT);
+    printf("%s  -s %d: rewind can go back %d commands, or %d seconds before the latest time\n%s",RED,flagStream,STREAM_REWIND,flagStream,WHT);
+    syntaxError(cur,"Can't go back that far when streaming.\n");
+  }
+}
+
+static void streamOut(void) {
+  if (flagStream<=0) {
+    return;
+  }
+  double mark=masterTime;
+  size_t depth=rewindHistory.size();
+  if (depth>STREAM_REWIND) {
+    depth=STREAM_REWIND;
+  }
+  for (size_t i=rewindHistory.size()-depth;i<rewindHistory.size();i++) {
+    if (rewindHistory[i]<mark) {
+      mark=rewindHistory[i];
+    }
+  }
+  mark-=flagStream;
+  if (mark<=streamedTime) {
+    return;
+  }
+
+  // whole pages only, and nothing past the end of the audio yet
+  
+  uint32_t markX=wavout->findPosition(mark);
+  if (markX>wavout->maxPos) {
+    markX=wavout->maxPos;
+  }
+  markX&=~PAGE_MASK;
+  if (markX<=wavout->streamedX) {
+    return;
+  }
+
+  jobsWait();          // nothing may still be writing back there
+  
+  if (!wavout->isOpen()) {
+    pickOutputFile();
+    printf("%sStreaming to %s%s\n",CYN,outputFile,WHT);
+    wavout->streamOpen(outputFile);
+  }
+  wavout->streamTo(markX);
+  streamedTime=markX/double(SR);
+}
+
+//----------------------------------------------------------------------
+// Some words are only keywords after the command they belong to, so
+// that scripts can still use them as variable names. Anywhere else on
+// the line, or as the value of the keyword itself (tap tap), they
+// are turned back into a STRING.
+
+static const int clauseWords[][2] = {
+  {TAP,REVERB},               // reverb <length> <delay> tap <delay> <gain>
+  {SIZE,ROOM},                // room <length> <decay> size <size>
+  {LOWPASS,FILTER},           // filter <length> <type> <cutoff> q <q> stages <n>
+  {HIGHPASS,FILTER},
+  {BANDPASS,FILTER},
+  {NOTCH,FILTER},
+  {Q,FILTER},
+  {STAGES,FILTER},
+  {HZ,PARTIAL},               // partial <multiple> <vol> hz offset <cycles>
+  {OFFSET,PARTIAL},
+};
+
+void scanForClauseWords(void) {
+  for (node *ptr=begn;ptr!=NULL;ptr=ptr->rght) {
+    for (auto &cw : clauseWords) {
+      if (ptr->dtype!=cw[0]) {
+        continue;
+      }
+      node *n=ptr->lft;
+      while ((n!=NULL) && (n->dtype!=cw[1])) {
+        n=n->lft;
+      }
+      if ((n==NULL) || (ptr->lft->dtype==cw[0])) {
+        ptr->dtype=STRING;
+        ptr->value=NO_NUMBER;
+        ptr->str=strdup(debug_type(cw[0]));
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------
+// a file a script reads (an IR) is looked for next to the script if
+// it isn't in the current directory, so t1/ runs from anywhere
+
+static const char * nextToScript(const char * name) {
+  FILE *f=fopen(name,"rb");
+  if (f!=NULL) {
+    fclose(f);
+    return name;
+  }
+  const char *slash=strrchr(copyinfile,'/');
+  if (slash==NULL) {
+    return name;
+  }
+  string path=string(copyinfile,slash-copyinfile+1)+name;
+  return strdup(path.c_str());
+}
+
+//----------------------------------------------------------------------
+// true for the nodes the lexer makes from a keyword
+
+static bool isKeyword(node * n) {
+  int t=n->dtype;
+  if ((t>NUMBER) && (t<COMMA)) {
+    return (t!=TIMESTAMP) && (t!=ASSIGNLHS);
+  }
+  return ((t>=WF_SINE) && (t<=WF_BANDNOISE)) || ((t>=SH_TEASE1) && (t<=LASTSHAPE));
+}
+
 //----------------------------------------------------------------------
 // We're looking for nodes STRING,= in that order.
 // If we find it, we turn the STRING into a NOOP
@@ -1658,6 +1873,14 @@ void scanForAssignments(void) {
       foundString=false;
       //printf("DEBUG: stored %s in '='\n",ptr->str);
     }
+    else if (ptr->dtype==ASSIGNMENT) {
+      node *left=ptr->lft;
+      if ((left!=NULL) && isKeyword(left)) {
+        string msg=string(debug_type(left->dtype))+" is a reserved word\n";
+        syntaxError(left,msg.c_str());
+      }
+      syntaxError(ptr,"Missing left hand side of assignment.\n");
+    }
     else {
       foundString=false;
     }
@@ -2133,6 +2356,62 @@ void doStuff(void) {
       if (item==NULL) syntaxError(cur,"No volume specified.\n");
       settings.vol3=item;
     }
+    else if (cur->dtype==PARTIAL) {
+      printf("cmd: partial\n");
+
+      // partial <multiple of freq> <vol>, then hz and offset up to the
+      // next partial. The partials on a line replace any from before.
+
+      Partial p;
+      p.freq=CheckRight(cur);
+      p.amp=CheckRight(GetRight(cur));
+      if ((p.freq==NULL) || (p.amp==NULL)) {
+        syntaxError(cur,"A partial needs a multiple of freq and a volume: partial 2 .5\n");
+      }
+      p.hz=false;
+      p.offset=0;
+      p.name="partial";
+      for (node * n=GetRight(cur);(n!=NULL) && (n->dtype!=PARTIAL);n=GetRight(n)) {
+        if (n->dtype==HZ) {
+          p.hz=true;
+        }
+        else if (n->dtype==OFFSET) {
+          p.offset=NumberRight(n);
+          if (p.offset==NO_NUMBER) {
+            syntaxError(n,"An offset needs a phase in cycles: offset .25\n");
+          }
+        }
+      }
+
+      if (!settings.newPartials) {
+        settings.partials.clear();
+        settings.newPartials=true;
+      }
+      if (settings.partials.size()==BANK_PARTIALS) {
+        syntaxError(cur,"Too many partials on one sound.\n");
+      }
+      settings.partials.insert(settings.partials.begin(),p);   // line is read right to left
+    }
+    else if (cur->dtype==CHORD) {
+      printf("cmd: chord\n");
+
+      // the partials are played once for each multiple of freq
+
+      settings.chord.clear();
+      for (node * n=cur;NumberRight(n)!=NO_NUMBER;n=GetRight(n)) {
+        double m=NumberRight(n);
+        if (m<=0) {
+          syntaxError(cur,"Chord notes are multiples of freq, above 0.\n");
+        }
+        if (settings.chord.size()==BANK_VOICES) {
+          syntaxError(cur,"Too many notes in one chord.\n");
+        }
+        settings.chord.push_back(m);
+      }
+      if (settings.chord.empty()) {
+        syntaxError(cur,"A chord needs multiples of freq: chord 1 1.25 1.5\n");
+      }
+    }
     else if (cur->dtype==BAL) {        // range -1 to 1
       printf("cmd: bal\n");
       item=CheckRight(cur);
@@ -2204,15 +2483,30 @@ void doStuff(void) {
       }
       else {
         for (int i=1; i<steps; i++) {
-          masterTime=rewindHistory.top();
+          masterTime=rewindHistory.back();
           // printf("rewind debug skipping %f \n",masterTime);
-          rewindHistory.pop();
+          rewindHistory.pop_back();
         }
-        masterTime=rewindHistory.top();
+        masterTime=rewindHistory.back();
         printf("%srewinding to time %f \n%s",GRN,masterTime,WHT);
       }
     }
 
+    // seed for noise and randseq, from here on (see easy_rand.hpp)
+
+    else if (cur->dtype==SEED) {
+      printf("cmd: seed\n");
+      double seed=NumberRight(cur);
+      if ((seed==NO_NUMBER) || (seed<0) || (seed!=floor(seed))) {
+        syntaxError(cur,"Seed needs a whole number, 0 or more.\n");
+      }
+      if (seed>SEED_MAX) {
+        syntaxError(cur,"Seed is out of range, it goes up to 16777216.\n");
+      }
+      randSeed=seed;
+      randStreams=0;
+    }
+
 
     //--------------------------------------------------
     // simple toggles
@@ -2224,13 +2518,36 @@ void doStuff(void) {
       settings.fadein=NumberRight(cur);
     }
     else if (cur->dtype==CIRCUIT) {             
-      printf("cmd: circuit\n");
-      settings.circuit=true;
+      double circuitLength=NumberRight(cur);
+
+      if (circuitLength==NO_NUMBER) {                                    // setting
+        printf("cmd: circuit\n");
+        settings.circuit=true;
+      }
+      else {                                                             // after effect
+        printf("cmd: circuit %f\n",circuitLength);
+
+        rewindHistory.push_back(masterTime);
+        if (circuitLength<0) {
+          syntaxError(cur,"Circuit must have a length (this is the source audio span).\n");
+        }
+        streamCheck(cur);
+        jobsWait();                        // works on what is there
+        doCircuit(circuitLength);
+        updateDefaults=false;
+        masterTime+=circuitLength;
+        streamOut();
+      }
     }
     else if (cur->dtype==NOCIRCUIT) {           
       printf("cmd: nocircuit\n");
       settings.circuit=false;
     }
+    else if (cur->dtype==NOPARTIALS) {
+      printf("cmd: nopartials\n");
+      settings.partials.clear();
+      settings.newPartials=true;
+    }
     else if (cur->dtype==MANUALMIX) {           
       printf("cmd: manualmix\n");
       settings.automix=1000.;
@@ -2260,15 +2577,22 @@ void doStuff(void) {
     }
     else if (cur->dtype==WF_SQUARE) {        
       printf("cmd: square\n");
-      settings.formStack.push(WF_SQUARE);
+      settings.formStack.push(WF_SQUARE+blepRight(cur));
     }
     else if (cur->dtype==WF_SAW) {           
       printf("cmd: saw\n");
-      settings.formStack.push(WF_SAW);
+      settings.formStack.push(WF_SAW+blepRight(cur));
     }
     else if (cur->dtype==WF_TRI) {           
       printf("cmd: tri\n");
-      settings.formStack.push(WF_TRI);
+      settings.formStack.push(WF_TRI+blepRight(cur));
+    }
+    else if (cur->dtype==BLEP) {
+      node * form=GetLeft(cur);
+      if ((form==NULL) ||
+          ((form->dtype!=WF_SQUARE) && (form->dtype!=WF_SAW) && (form->dtype!=WF_TRI))) {
+        syntaxError(cur,"blep goes straight after square, saw or tri.\n");
+      }
     }
     else if (cur->dtype==WF_TENS) {          
       printf("cmd: tens\n");
@@ -2278,6 +2602,18 @@ void doStuff(void) {
       printf("cmd: noise\n");
       settings.formStack.push(WF_NOISE);
     }
+    else if (cur->dtype==WF_PINK) {
+      printf("cmd: pink\n");
+      settings.formStack.push(WF_PINK);
+    }
+    else if (cur->dtype==WF_BROWN) {
+      printf("cmd: brown\n");
+      settings.formStack.push(WF_BROWN);
+    }
+    else if (cur->dtype==WF_BANDNOISE) {
+      printf("cmd: bandnoise\n");
+      settings.formStack.push(WF_BANDNOISE);
+    }
 
     // handle all the sound shapes here. These are all simple
     // settings that optionally take a single optional parameter
@@ -2488,11 +2824,14 @@ void doStuff(void) {
         syntaxError(cur,"A sound must have a length.\n");
       }
       else {
-        rewindHistory.push(masterTime);
-        doSound(soundLength,false);
+        streamCheck(cur);
+        rewindHistory.push_back(masterTime);
+        noiseKey=newRandKey();
+        jobSound(soundLength);
         updateDefaults=false;
         // printf("don't update defaults\n");
         masterTime+=soundLength;
+        streamOut();
       }
     }
       
@@ -2506,12 +2845,15 @@ void doStuff(void) {
         syntaxError(cur,"A sound must have a length.\n");
       }
       else {
-        rewindHistory.push(masterTime);
-        doSound(soundLength,true);           // write to scratch space first
+        streamCheck(cur);
+        rewindHistory.push_back(masterTime);
+        jobsWait();                          // mix reads what is there
+        noiseKey=newRandKey();
         doMix(soundLength);
         updateDefaults=false;
         // printf("don't update defaults\n");
         masterTime+=soundLength;
+        streamOut();
       }
     }
 
@@ -2523,11 +2865,13 @@ void doStuff(void) {
         syntaxError(cur,"Silence must have a length.\n");
       }
       else {
-        rewindHistory.push(masterTime);
-        doSilence(silenceLength);
+        streamCheck(cur);
+        rewindHistory.push_back(masterTime);
+        jobSilence(silenceLength);
         updateDefaults=false;
         printf("don't update defaults\n");
         masterTime+=silenceLength;
+        streamOut();
       }
     }
 
@@ -2536,7 +2880,7 @@ void doStuff(void) {
              
       double boostLength=NumberRight(cur);
       soundLengthX=boostLength*SR;        // needed for shape and ramp
-      rewindHistory.push(masterTime);
+      rewindHistory.push_back(masterTime);
 
 //      NumberDriver * boostAmount=CheckRight(cur->rght);
       NumberDriver * boostAmount=settings.vol;
@@ -2549,16 +2893,19 @@ void doStuff(void) {
         syntaxError(cur,"Boost must have a multiplier: >1 amplify <1 quieten <0 invert\n");
       }
       else {
+        streamCheck(cur);
+        jobsWait();                          // boost works on what is there
         doBoost(boostLength, boostAmount);
         updateDefaults=false;
         masterTime+=boostLength;
+        streamOut();
       }
     }
 
     else if (cur->dtype==REVERB) {                                       // after effect
       printf("cmd: reverb\n");
              
-      rewindHistory.push(masterTime);
+      rewindHistory.push_back(masterTime);
       double reverbLength=NumberRight(cur);
       //      NumberDriver * boostAmount=CheckRight(cur->rght);  // done through vol
       NumberDriver * reverbDelay=CheckRight(cur->rght);
@@ -2572,10 +2919,155 @@ void doStuff(void) {
         syntaxError(cur,"Reverb must have a time delay. Typically, .001s to .5s\n");
       }
       else {
-        doReverb(reverbLength, reverbAmount, reverbDelay);
+
+        // the delay above is the first tap, any more are "tap delay gain"
+
+        NumberDriver * tapDelay[REVERB_TAPS];
+        double tapGain[REVERB_TAPS];
+        int taps=1;
+
+        tapDelay[0]=reverbDelay;
+        tapGain[0]=1.;
+        for (node * n=GetRight(cur);n!=NULL;n=GetRight(n)) {
+          if (n->dtype!=TAP) {
+            continue;
+          }
+          double d=NumberRight(n);
+          double g=NumberRight(GetRight(n));
+          if ((d==NO_NUMBER) || (g==NO_NUMBER) || (d<0)) {
+            syntaxError(cur,"A tap needs a delay and a gain: tap .3 .5\n");
+          }
+          if (taps==REVERB_TAPS) {
+            syntaxError(cur,"Too many taps on one reverb.\n");
+          }
+          tapDelay[taps]=new Value(d);
+          tapGain[taps]=g;
+          taps++;
+        }
+
+        streamCheck(cur);
+        jobsWait();                          // so does reverb
+        doReverb(reverbLength, reverbAmount, taps, tapDelay, tapGain);
+        for (int t=1;t<taps;t++) {
+          delete tapDelay[t];
+        }
         updateDefaults=false;
         masterTime+=reverbLength;
+        streamOut();
+      }
+    }
+
+    else if (cur->dtype==CONVOLVE) {                                     // after effect
+      printf("cmd: convolve\n");
+
+      rewindHistory.push_back(masterTime);
+      double convolveLength=NumberRight(cur);
+      node * irNode=GetRight(GetRight(cur));
+      const char * irFile=NULL;
+      double irDecay=0;
+
+      if (convolveLength<0) {
+        syntaxError(cur,"Convolve must have a length (this is the source audio span).\n");
+      }
+
+      if ((irNode!=NULL) && (irNode->dtype==FILENAME)) {
+        irFile=nextToScript(irNode->str);
+      }
+      else {
+        irDecay=(irNode!=NULL) ? NumberRight(GetRight(cur)) : NO_NUMBER;
+        if ((irDecay<=0) || (irDecay>IR_MAX_SECONDS)) {
+          syntaxError(cur,"Convolve needs an IR: a \"file.wav\" or a decay time in seconds\n");
+        }
+      }
+
+      streamCheck(cur);
+      jobsWait();                          // reads what is there too
+      doConvolve(convolveLength, settings.vol, irFile, irDecay);
+      updateDefaults=false;
+      masterTime+=convolveLength;
+      streamOut();
+    }
+
+    else if (cur->dtype==ROOM) {                                         // after effect
+      printf("cmd: room\n");
+
+      rewindHistory.push_back(masterTime);
+      double roomLength=NumberRight(cur);
+      NumberDriver * roomDecay=CheckRight(cur->rght);
+      NumberDriver * roomSize=NULL;
+
+      if (roomLength<0) {
+        syntaxError(cur,"Room must have a length (this is the source audio span).\n");
       }
+      if (roomDecay==NULL) {
+        syntaxError(cur,"Room must have a decay time (t60), typically .5s to 5s\n");
+      }
+
+      for (node * n=GetRight(cur);n!=NULL;n=GetRight(n)) {
+        if (n->dtype==SIZE) {
+          roomSize=CheckRight(n);
+          if (roomSize==NULL) {
+            syntaxError(cur,"Size needs a number, 1 is a middling hall.\n");
+          }
+        }
+      }
+      Value defaultSize(1.);
+
+      streamCheck(cur);
+      jobsWait();                          // reads what is there too
+      doRoom(roomLength, settings.vol, roomDecay, (roomSize!=NULL) ? roomSize : &defaultSize);
+      updateDefaults=false;
+      masterTime+=roomLength;
+      streamOut();
+    }
+
+    else if (cur->dtype==FILTER) {                                       // after effect
+      printf("cmd: filter\n");
+
+      rewindHistory.push_back(masterTime);
+      double filterLength=NumberRight(cur);
+      int filterType=0;
+      int filterStages=1;
+      NumberDriver * filterCutoff=NULL;
+      NumberDriver * filterQ=NULL;
+
+      if (filterLength<0) {
+        syntaxError(cur,"Filter must have a length (this is the source audio span).\n");
+      }
+
+      for (node * n=GetRight(cur);n!=NULL;n=GetRight(n)) {
+        if ((n->dtype==LOWPASS) || (n->dtype==HIGHPASS) || (n->dtype==BANDPASS) || (n->dtype==NOTCH)) {
+          filterType=n->dtype;
+          filterCutoff=CheckRight(n);
+          if (filterCutoff==NULL) {
+            syntaxError(cur,"The filter type is followed by the cutoff in Hz.\n");
+          }
+        }
+        else if (n->dtype==Q) {
+          filterQ=CheckRight(n);
+          if (filterQ==NULL) {
+            syntaxError(cur,"q needs a number, .7071 is the flattest.\n");
+          }
+        }
+        else if (n->dtype==STAGES) {
+          double st=NumberRight(n);
+          if ((st<1) || (st>FILTER_STAGES)) {
+            syntaxError(cur,"Stages goes from 1 to 8.\n");
+          }
+          filterStages=st;
+        }
+      }
+      if (filterType==0) {
+        syntaxError(cur,"Filter needs a type: lowpass, highpass, bandpass or notch.\n");
+      }
+      Value defaultQ(.7071);
+
+      streamCheck(cur);
+      jobsWait();                          // works on what is there
+      doFilter(filterLength, filterType, filterStages, filterCutoff, (filterQ!=NULL) ? filterQ : &defaultQ);
+      updateDefaults=false;
+      masterTime+=filterLength;
+      streamOut();
     }
 
     // --------------------------------------------------
@@ -2642,6 +3134,9 @@ void doStuff(void) {
     else if (cur->dtype==OUTPUT) {      // output: takes filename
       // printf("cmd: output\n");
 
+      if (wavout->isOpen()) {
+        syntaxError(cur,"Output has to come before anything is streamed out (-s)\n");
+      }
       outputFile=(char *) FilenameRight(cur);
       if (outputFile==NULL) {
         syntaxError(cur,"Output filename is not specified\n");
@@ -57,6 +57,10 @@ void displayForward();
 //void push(int dtype, float value, char * str);
 //void shift(int dtype, float value, char * str);
 
+// how many commands back rewind can go when streaming (-s)
+
+#define STREAM_REWIND 16
+
 // opcodes for parsing the input file:
 
 
@@ -66,6 +70,10 @@ void displayForward();
 #define WF_TRI 1003
 #define WF_TENS 1004
 #define WF_NOISE 1005
+#define WF_PINK 1006
+#define WF_BROWN 1007
+#define WF_BANDNOISE 1008
+#define WF_BLEP 0x10000      // added to SQUARE, SAW or TRI for polyBLEP
 
 #define PLUS -1
 #define MINUS -2
@@ -127,6 +135,24 @@ void displayForward();
 #define CALL 50
 #define REQUIRE 51
 #define CLEAR 52
+#define CONVOLVE 53
+#define TAP 54
+#define ROOM 55
+#define SIZE 56
+#define FILTER 57
+#define LOWPASS 58
+#define HIGHPASS 59
+#define BANDPASS 60
+#define NOTCH 61
+#define Q 62
+#define STAGES 63
+#define SEED 64
+#define PARTIAL 65
+#define HZ 66
+#define OFFSET 67
+#define CHORD 68
+#define NOPARTIALS 69
+#define BLEP 70
 
 #define COMMA 99
 
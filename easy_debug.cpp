@@ -14,6 +14,14 @@ const char * debug_type (int dtype) {
       return "tri";
     case WF_TENS:
       return "tens";
+    case WF_NOISE:
+      return "noise";
+    case WF_PINK:
+      return "pink";
+    case WF_BROWN:
+      return "brown";
+    case WF_BANDNOISE:
+      return "bandnoise";
 
     case PLUS:
       return " + ";
@@ -108,29 +116,69 @@ const char * debug_type (int dtype) {
     case TO:
       return "to";
     case FREQ2:
-      return "FREQ2";
+      return "freq2";
     case FREQ3:
-      return "FREQ3";
+      return "freq3";
     case VOL2:
-      return "VOL2";
+      return "vol2";
     case VOL3:
-      return "VOL3";
+      return "vol3";
     case RAMPS:
-      return "RAMPS";
+      return "ramps";
     case EXIT:
-      return "EXIT";
+      return "exit";
     case TIMESTAMP:
       return "TIMESTAMP";
     case ASSIGNLHS:
       return "ASSIGNLHS";
     case SUB:
-      return "SUB";
+      return "sub";
     case END:
-      return "END";
+      return "end";
     case CALL:
-      return "CALL";
+      return "call";
     case REQUIRE:
-      return "REQUIRE";
+      return "require";
+    case INCLUDE:
+      return "include";
+    case CLEAR:
+      return "clear";
+    case CONVOLVE:
+      return "convolve";
+    case TAP:
+      return "tap";
+    case ROOM:
+      return "room";
+    case SIZE:
+      return "size";
+    case FILTER:
+      return "filter";
+    case LOWPASS:
+      return "lowpass";
+    case HIGHPASS:
+      return "highpass";
+    case BANDPASS:
+      return "bandpass";
+    case NOTCH:
+      return "notch";
+    case Q:
+      return "q";
+    case STAGES:
+      return "stages";
+    case SEED:
+      return "seed";
+    case PARTIAL:
+      return "partial";
+    case HZ:
+      return "hz";
+    case OFFSET:
+      return "offset";
+    case CHORD:
+      return "chord";
+    case NOPARTIALS:
+      return "nopartials";
+    case BLEP:
+      return "blep";
 
     case SH_TEASE1:
       return "tease1";
@@ -139,7 +187,7 @@ const char * debug_type (int dtype) {
     case SH_TEASE3:
       return "tease3";
     case SH_PULSE1:
-      return "pulse";
+      return "pulse1";
     case SH_PULSE2:
       return "pulse2";
     case SH_PULSE3:
@@ -173,9 +221,9 @@ const char * debug_type (int dtype) {
     case SH_WEDGE2:
       return "wedge2";
     case SH_GAP1:
-      return "rev3";
+      return "gap1";
     case SH_GAP2:
-      return "rev3";
+      return "gap2";
   }
 return "Unknown";
 }
@@ -0,0 +1,225 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// fdn
+//
+// The feedback delay network described in easy_fdn.hpp.
+//
+//----------------------------------------------------------------------
+
+extern "C" {
+  #include "easy_code.h"
+}
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "easy.hpp"
+#include "easy_fdn.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// line lengths at size 1 in seconds. None is a multiple of another
+// or close to one, so their echoes don't land together.
+
+static const double fdnLength[FDN_LINES]={
+  .0297, .0371, .0411, .0437, .0533, .0599, .0671, .0739
+};
+
+// which way round the input goes into each line. Left and right
+// take alternate lines.
+
+static const float fdnSign[FDN_LINES]={
+  1, 1, -1, -1, 1, -1, -1, 1
+};
+
+//----------------------------------------------------------------------
+
+Fdn::Fdn() {
+  uint32_t longest=fdnLength[FDN_LINES-1]*FDN_SIZE_MAX*SR+2;
+  uint32_t frames=1;
+
+  while (frames<longest+BLOCK_SIZE) {
+    frames<<=1;
+  }
+  mask=frames-1;
+  at=0;
+  ring=new float[frames*FDN_LINES]();
+  taps=new float[BLOCK_SIZE*FDN_LINES];
+
+  for (int k=0;k<FDN_LINES;k++) {
+    lp[k]=0;
+  }
+  set(1.,1.);
+}
+
+Fdn::~Fdn() {
+  delete[] ring;
+  delete[] taps;
+}
+
+// With a line of d frames losing g each time round, the sound falls
+// 60dB after t60*SR/d trips, so g=10^(-3d/(t60*SR)). The one pole
+// filter g*(1-p)/(1-p/z) has gain g at DC and less above; p is
+// Jot's choice for t60 to be FDN_HF_RATIO as long at the top.
+
+void Fdn::set(double size, double decay) {
+  double smallest=(BLOCK_SIZE+2.)/(fdnLength[0]*SR);   // see read
+  if (smallest<FDN_SIZE_MIN) {
+    smallest=FDN_SIZE_MIN;
+  }
+  if (size<smallest) {
+    size=smallest;
+  }
+  if (size>FDN_SIZE_MAX) {
+    size=FDN_SIZE_MAX;
+  }
+  if (decay<FDN_T60_MIN) {
+    decay=FDN_T60_MIN;
+  }
+  if (decay>FDN_T60_MAX) {
+    decay=FDN_T60_MAX;
+  }
+  t60=decay;
+
+  double hf=1.-1./(FDN_HF_RATIO*FDN_HF_RATIO);
+  double mean=0;
+
+  for (int k=0;k<FDN_LINES;k++) {
+    delay[k]=fdnLength[k]*size*SR;
+    double lg=-3.*delay[k]/(t60*SR);     // log10 of the gain
+    double pk=log(10.)/4.*lg*hf;
+    if (pk>.95) {                        // short t60 in a big room
+      pk=.95;
+    }
+    b[k]=pow(10.,lg)*(1.-pk);
+    p[k]=pk;
+    mean+=delay[k]/FDN_LINES;
+  }
+
+  // a unit impulse in leaves (g^2+g^4+...) of energy in the lines for
+  // a line of the average length, and each side reads half of them
+
+  double g2=pow(10.,-6.*mean/(t60*SR));
+  outScale=sqrt((1.-g2)/g2);
+}
+
+// the last n frames of each line, at its length back from each of
+// the frames about to be written. A length that isn't whole frames
+// is read between the two either side. The newest frame read is
+// at+n-1-(delay-1), so the shortest line must be over n+1 frames or
+// it would be one this block hasn't written yet.
+
+void Fdn::read(uint32_t n) {
+  for (int k=0;k<FDN_LINES;k++) {
+    uint32_t whole=ceil(delay[k]);
+    float f=whole-delay[k];
+    uint32_t from=at-whole;
+
+    for (uint32_t i=0;i<n;i++) {
+      float x0=ring[((from+i)&mask)*FDN_LINES+k];
+      float x1=ring[((from+i+1)&mask)*FDN_LINES+k];
+      taps[i*FDN_LINES+k]=x0*(1-f)+x1*f;
+    }
+  }
+}
+
+//----------------------------------------------------------------------
+// per frame, with y the filtered line outputs and H the 8x8 Hadamard
+// matrix (done as three rounds of sum and difference):
+//
+//   h=H*y    out: left=(h[0]+h[1])/2 (even lines), right=(h[0]-h[1])/2
+//   line k gets h[k]/sqrt(8) + input*sign[k]
+
+#ifdef __SSE2__
+
+void Fdn::process(const float *inL, const float *inR, float *outL, float *outR, uint32_t n) {
+  const __m128 bA=_mm_loadu_ps(b);
+  const __m128 bB=_mm_loadu_ps(b+4);
+  const __m128 pA=_mm_loadu_ps(p);
+  const __m128 pB=_mm_loadu_ps(p+4);
+  const __m128 sgn2=_mm_set_ps(-1.f,-1.f,1.f,1.f);
+  const __m128 sgn1=_mm_set_ps(-1.f,1.f,-1.f,1.f);
+  const __m128 inA=_mm_loadu_ps(fdnSign);
+  const __m128 inB=_mm_loadu_ps(fdnSign+4);
+  const __m128 norm=_mm_set1_ps(1./sqrt(FDN_LINES));
+  __m128 yA=_mm_loadu_ps(lp);
+  __m128 yB=_mm_loadu_ps(lp+4);
+
+  read(n);
+
+  for (uint32_t i=0;i<n;i++) {
+    const float *x=taps+i*FDN_LINES;
+    float *w=ring+((at+i)&mask)*FDN_LINES;
+
+    yA=_mm_add_ps(_mm_mul_ps(bA,_mm_loadu_ps(x)),_mm_mul_ps(pA,yA));
+    yB=_mm_add_ps(_mm_mul_ps(bB,_mm_loadu_ps(x+4)),_mm_mul_ps(pB,yB));
+
+    __m128 hA=_mm_add_ps(yA,yB);
+    __m128 hB=_mm_sub_ps(yA,yB);
+    hA=_mm_add_ps(_mm_movelh_ps(hA,hA),_mm_mul_ps(_mm_movehl_ps(hA,hA),sgn2));
+    hB=_mm_add_ps(_mm_movelh_ps(hB,hB),_mm_mul_ps(_mm_movehl_ps(hB,hB),sgn2));
+    hA=_mm_add_ps(_mm_shuffle_ps(hA,hA,_MM_SHUFFLE(2,2,0,0)),
+                  _mm_mul_ps(_mm_shuffle_ps(hA,hA,_MM_SHUFFLE(3,3,1,1)),sgn1));
+    hB=_mm_add_ps(_mm_shuffle_ps(hB,hB,_MM_SHUFFLE(2,2,0,0)),
+                  _mm_mul_ps(_mm_shuffle_ps(hB,hB,_MM_SHUFFLE(3,3,1,1)),sgn1));
+
+    float h0=_mm_cvtss_f32(hA);
+    float h1=_mm_cvtss_f32(_mm_shuffle_ps(hA,hA,_MM_SHUFFLE(1,1,1,1)));
+    outL[i]=(h0+h1)*.5f*outScale;
+    outR[i]=(h0-h1)*.5f*outScale;
+
+    __m128 lr=_mm_unpacklo_ps(_mm_set1_ps(inL[i]),_mm_set1_ps(inR[i]));
+    _mm_storeu_ps(w,_mm_add_ps(_mm_mul_ps(hA,norm),_mm_mul_ps(lr,inA)));
+    _mm_storeu_ps(w+4,_mm_add_ps(_mm_mul_ps(hB,norm),_mm_mul_ps(lr,inB)));
+  }
+
+  _mm_storeu_ps(lp,yA);
+  _mm_storeu_ps(lp+4,yB);
+  at+=n;
+}
+
+#else
+
+void Fdn::process(const float *inL, const float *inR, float *outL, float *outR, uint32_t n) {
+  const float norm=1./sqrt(FDN_LINES);
+  float h[FDN_LINES];
+  float t[FDN_LINES];
+
+  read(n);
+
+  for (uint32_t i=0;i<n;i++) {
+    const float *x=taps+i*FDN_LINES;
+    float *w=ring+((at+i)&mask)*FDN_LINES;
+
+    for (int k=0;k<FDN_LINES;k++) {
+      lp[k]=b[k]*x[k]+p[k]*lp[k];
+    }
+    for (int k=0;k<4;k++) {
+      t[k]=lp[k]+lp[k+4];
+      t[k+4]=lp[k]-lp[k+4];
+    }
+    for (int k=0;k<FDN_LINES;k+=4) {
+      h[k]=t[k]+t[k+2];
+      h[k+1]=t[k+1]+t[k+3];
+      h[k+2]=t[k]-t[k+2];
+      h[k+3]=t[k+1]-t[k+3];
+    }
+    for (int k=0;k<FDN_LINES;k+=2) {
+      t[k]=h[k]+h[k+1];
+      t[k+1]=h[k]-h[k+1];
+    }
+
+    outL[i]=(t[0]+t[1])*.5f*outScale;
+    outR[i]=(t[0]-t[1])*.5f*outScale;
+
+    for (int k=0;k<FDN_LINES;k++) {
+      w[k]=t[k]*norm+((k&1) ? inR[i] : inL[i])*fdnSign[k];
+    }
+  }
+  at+=n;
+}
+
+#endif
@@ -0,0 +1,77 @@
+//----------------------------------------------------------------------
+// Feedback delay network (FDN), for the room reverb.
+//
+// FDN_LINES delay lines of different lengths. Whatever comes out of
+// the lines goes through a damping filter each, is mixed across all
+// of them by a Hadamard matrix and fed back in along with the input.
+// The matrix is scaled to lose no energy, so how fast the sound dies
+// away is set by the filters alone: each line's gain is picked from
+// its length so all of them fall 60dB in the same time (t60), and
+// each filter takes off more at the top so the highs go first the
+// way they do in a real room (Jot's absorbent delay lines). Mixing
+// every line into every other one each time round is what makes the
+// echoes pile up into a smooth tail instead of a flutter.
+//
+// Nothing is fed back quicker than the shortest line, so a whole
+// block of line outputs can be read before any of it is written.
+// The per-frame work is then the same for all lines and they are
+// kept side by side in memory, one frame of all lines in a row, so
+// with SSE2 the filters, matrix and write are done for the 8 lines
+// in two vectors. The scalar version does the same operations in
+// the same order and gives exactly the same numbers.
+
+#ifndef EASY_FDN_HPP
+#define EASY_FDN_HPP 1
+
+#include <stdint.h>
+
+#define FDN_LINES 8                // process() is written for 8
+
+#define FDN_SIZE_MIN .25           // size 1 is a middling hall
+#define FDN_SIZE_MAX 4.
+#define FDN_T60_MIN .1             // seconds to die away by 60dB
+#define FDN_T60_MAX 30.
+#define FDN_HF_RATIO .5            // t60 at the top over t60 at DC
+
+//----------------------------------------------------------------------
+// stereo in, stereo reverb out. Left goes into the even lines and
+// right into the odd ones, each with its line's sign. The output is
+// tapped from the mixing matrix after the damping filters: left is
+// (h[0]+h[1])/2 and right (h[0]-h[1])/2, the sum and difference of
+// the first two Hadamard rows. Every line feeds all the others through
+// the matrix, so both sides carry both inputs once the tail builds.
+
+class Fdn {
+public:
+  double t60;                  // as last set, clamped
+
+  Fdn();
+  ~Fdn();
+
+  // room size and t60 for the frames that follow. Can change between
+  // blocks; the line lengths are read with interpolation so they
+  // don't have to be whole frames.
+
+  void set(double size, double decay);
+
+  // n frames, no more than BLOCK_SIZE
+
+  void process(const float *inL, const float *inR, float *outL, float *outR, uint32_t n);
+
+private:
+  float *ring;                 // FDN_LINES floats per frame
+  uint32_t mask;               // frames in ring less 1, a power of 2
+  uint32_t at;                 // next frame written
+
+  double delay[FDN_LINES];     // frames
+  float b[FDN_LINES];          // filter: y=b*x+p*y
+  float p[FDN_LINES];
+  float lp[FDN_LINES];         // last y
+  float outScale;              // keeps the tail's energy near 1
+
+  float *taps;                 // BLOCK_SIZE frames read from the lines
+
+  void read(uint32_t n);
+};
+
+#endif
@@ -0,0 +1,261 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// fft
+//
+// The FFT and the partitioned convolution described in easy_fft.hpp.
+//
+//----------------------------------------------------------------------
+
+extern "C" {
+  #include "easy_code.h"
+}
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "easy_fft.hpp"
+
+//----------------------------------------------------------------------
+// FFT
+
+FFT::FFT(int size) {
+  int bits=0;
+
+  n=size;
+  while ((1<<bits)<n) {
+    bits++;
+  }
+  if ((1<<bits)!=n) {
+    printf("%sError - FFT size %d is not a power of 2\n%s",RED,n,WHT);
+    exit(2);
+  }
+
+  cosT=new double[n/2];
+  sinT=new double[n/2];
+  for (int i=0;i<n/2;i++) {
+    cosT[i]=cos(2.*M_PI*i/n);
+    sinT[i]=sin(2.*M_PI*i/n);
+  }
+
+  rev=new int[n];
+  for (int i=0;i<n;i++) {
+    int r=0;
+    for (int b=0;b<bits;b++) {
+      if (i&(1<<b)) {
+        r|=1<<(bits-1-b);
+      }
+    }
+    rev[i]=r;
+  }
+}
+
+FFT::~FFT() {
+  delete[] cosT;
+  delete[] sinT;
+  delete[] rev;
+}
+
+// sign is -1 forward, +1 inverse. Stages are done with the twiddle
+// for each butterfly read from the table at a stride, so there is no
+// running product to drift.
+
+void FFT::run(double *re, double *im, double sign) {
+  for (int i=0;i<n;i++) {
+    int j=rev[i];
+    if (j>i) {
+      double t=re[i];
+      re[i]=re[j];
+      re[j]=t;
+      t=im[i];
+      im[i]=im[j];
+      im[j]=t;
+    }
+  }
+
+  for (int len=2;len<=n;len<<=1) {
+    int half=len>>1;
+    int stride=n/len;
+    for (int i=0;i<n;i+=len) {
+      for (int k=0;k<half;k++) {
+        double wr=cosT[k*stride];
+        double wi=sign*sinT[k*stride];
+        int a=i+k;
+        int b=a+half;
+        double tr=re[b]*wr-im[b]*wi;
+        double ti=re[b]*wi+im[b]*wr;
+        re[b]=re[a]-tr;
+        im[b]=im[a]-ti;
+        re[a]+=tr;
+        im[a]+=ti;
+      }
+    }
+  }
+}
+
+void FFT::forward(double *re, double *im) {
+  run(re,im,-1.);
+}
+
+void FFT::inverse(double *re, double *im) {
+  run(re,im,1.);
+  double scale=1./n;
+  for (int i=0;i<n;i++) {
+    re[i]*=scale;
+    im[i]*=scale;
+  }
+}
+
+//----------------------------------------------------------------------
+// With Z the transform of l+i*r and both real:
+//
+//   L[k]=(Z[k]+conj(Z[n-k]))/2     R[k]=(Z[k]-conj(Z[n-k]))/2i
+//
+// and going back, Z[k]=L[k]+i*R[k] with Z[n-k]=conj(L[k])+i*conj(R[k]).
+
+static void split(const double *re, const double *im, int n, uint32_t bins,
+                  double *lre, double *lim, double *rre, double *rim) {
+  for (uint32_t k=0;k<bins;k++) {
+    uint32_t m=(k==0) ? 0 : n-k;
+    double a=re[k];
+    double b=im[k];
+    double c=re[m];
+    double d=im[m];
+    lre[k]=.5*(a+c);
+    lim[k]=.5*(b-d);
+    rre[k]=.5*(b+d);
+    rim[k]=.5*(c-a);
+  }
+}
+
+//----------------------------------------------------------------------
+// Convolver
+
+Convolver::Convolver(const float *irL, const float *irR, uint32_t len) : fft(2*CONV_BLOCK) {
+  uint32_t n=2*CONV_BLOCK;
+
+  bins=CONV_BLOCK+1;
+  parts=(len+CONV_BLOCK-1)/CONV_BLOCK;
+  if (parts<1) {
+    parts=1;
+  }
+
+  hLre=new double[parts*bins];
+  hLim=new double[parts*bins];
+  hRre=new double[parts*bins];
+  hRim=new double[parts*bins];
+  xLre=new double[parts*bins]();
+  xLim=new double[parts*bins]();
+  xRre=new double[parts*bins]();
+  xRim=new double[parts*bins]();
+  yLre=new double[bins];
+  yLim=new double[bins];
+  yRre=new double[bins];
+  yRim=new double[bins];
+  re=new double[n];
+  im=new double[n];
+  lastL=new float[CONV_BLOCK]();
+  lastR=new float[CONV_BLOCK]();
+  xAt=0;
+
+  // each part is zero padded to the FFT size, which is what makes the
+  // second half of every output block come out unwrapped
+
+  for (uint32_t p=0;p<parts;p++) {
+    for (uint32_t i=0;i<n;i++) {
+      uint32_t at=p*CONV_BLOCK+i;
+      bool in=(i<CONV_BLOCK) && (at<len);
+      re[i]=in ? irL[at] : 0;
+      im[i]=in ? irR[at] : 0;
+    }
+    fft.forward(re,im);
+    split(re,im,n,bins,hLre+p*bins,hLim+p*bins,hRre+p*bins,hRim+p*bins);
+  }
+}
+
+Convolver::~Convolver() {
+  delete[] hLre;
+  delete[] hLim;
+  delete[] hRre;
+  delete[] hRim;
+  delete[] xLre;
+  delete[] xLim;
+  delete[] xRre;
+  delete[] xRim;
+  delete[] yLre;
+  delete[] yLim;
+  delete[] yRre;
+  delete[] yRim;
+  delete[] re;
+  delete[] im;
+  delete[] lastL;
+  delete[] lastR;
+}
+
+void Convolver::process(const float *inL, const float *inR, float *outL, float *outR) {
+  uint32_t n=2*CONV_BLOCK;
+
+  // overlap-save: the last block and this one
+
+  for (uint32_t i=0;i<CONV_BLOCK;i++) {
+    re[i]=lastL[i];
+    im[i]=lastR[i];
+    re[CONV_BLOCK+i]=inL[i];
+    im[CONV_BLOCK+i]=inR[i];
+  }
+  memcpy(lastL,inL,CONV_BLOCK*sizeof(float));
+  memcpy(lastR,inR,CONV_BLOCK*sizeof(float));
+
+  fft.forward(re,im);
+
+  xAt=(xAt+1)%parts;
+  uint32_t o=xAt*bins;
+  split(re,im,n,bins,xLre+o,xLim+o,xRre+o,xRim+o);
+
+  // part p of the IR goes with the input from p blocks ago
+
+  for (uint32_t k=0;k<bins;k++) {
+    yLre[k]=0;
+    yLim[k]=0;
+    yRre[k]=0;
+    yRim[k]=0;
+  }
+
+  for (uint32_t p=0;p<parts;p++) {
+    uint32_t xo=((xAt+parts-p)%parts)*bins;
+    uint32_t ho=p*bins;
+    for (uint32_t k=0;k<bins;k++) {
+      double ar=xLre[xo+k];
+      double ai=xLim[xo+k];
+      double br=hLre[ho+k];
+      double bi=hLim[ho+k];
+      yLre[k]+=ar*br-ai*bi;
+      yLim[k]+=ar*bi+ai*br;
+
+      ar=xRre[xo+k];
+      ai=xRim[xo+k];
+      br=hRre[ho+k];
+      bi=hRim[ho+k];
+      yRre[k]+=ar*br-ai*bi;
+      yRim[k]+=ar*bi+ai*br;
+    }
+  }
+
+  // put the two back together as one spectrum and transform back
+
+  for (uint32_t k=0;k<bins;k++) {
+    re[k]=yLre[k]-yRim[k];
+    im[k]=yLim[k]+yRre[k];
+    if ((k>0) && (k<CONV_BLOCK)) {
+      re[n-k]=yLre[k]+yRim[k];
+      im[n-k]=yRre[k]-yLim[k];
+    }
+  }
+
+  fft.inverse(re,im);
+
+  for (uint32_t i=0;i<CONV_BLOCK;i++) {
+    outL[i]=re[CONV_BLOCK+i];
+    outR[i]=im[CONV_BLOCK+i];
+  }
+}
@@ -0,0 +1,85 @@
+//----------------------------------------------------------------------
+// FFT and partitioned convolution, for the convolution reverb.
+//
+// Convolving with an impulse response (IR) seconds long straight from
+// the definition costs one multiply per IR sample per output sample,
+// 100k+ at 48k. Instead the IR is cut into parts of CONV_BLOCK
+// samples and each part is kept as a spectrum. The input is taken a
+// block at a time and transformed once; each output block is then
+// the sum over the parts of (spectrum of an earlier input block) *
+// (spectrum of the part), transformed back. That is "uniformly
+// partitioned overlap-save". The work per sample is one FFT of
+// 2*CONV_BLOCK spread over CONV_BLOCK samples plus one complex
+// multiply per part.
+//
+// Both channels go through together as the real and imaginary halves
+// of one complex FFT. Because the samples and the IR are real they
+// can be pulled apart again from the symmetry of the spectrum, so a
+// stereo block costs one FFT each way, not two.
+
+#ifndef EASY_FFT_HPP
+#define EASY_FFT_HPP 1
+
+#include <stdint.h>
+
+// samples per block and per IR part. Nothing is played live, so the
+// delay of one block doesn't matter and bigger means fewer parts.
+
+#define CONV_BLOCK 4096
+
+#define IR_MAX_SECONDS 30          // longest IR convolve will take
+
+//----------------------------------------------------------------------
+// radix 2 complex FFT of a fixed size n (a power of 2), in place on
+// separate real and imaginary arrays. inverse divides by n.
+
+class FFT {
+public:
+  int n;
+  double *cosT;                // twiddles for n/2 steps round the circle
+  double *sinT;
+  int *rev;                    // bit reversed index
+
+  FFT(int size);
+  ~FFT();
+
+  void forward(double *re, double *im);
+  void inverse(double *re, double *im);
+
+private:
+  void run(double *re, double *im, double sign);
+};
+
+//----------------------------------------------------------------------
+// stereo convolution with an IR of len samples per channel
+
+class Convolver {
+public:
+  uint32_t parts;              // IR parts of CONV_BLOCK
+
+  Convolver(const float *irL, const float *irR, uint32_t len);
+  ~Convolver();
+
+  // one block of CONV_BLOCK samples in, the same out
+
+  void process(const float *inL, const float *inR, float *outL, float *outR);
+
+private:
+  FFT fft;
+  uint32_t bins;               // CONV_BLOCK+1, the rest is mirrored
+
+  // spectra, bins values per part (H) or per earlier input block (X).
+  // X is a ring, newest at xAt.
+
+  double *hLre, *hLim, *hRre, *hRim;
+  double *xLre, *xLim, *xRre, *xRim;
+  uint32_t xAt;
+  double *yLre, *yLim, *yRre, *yRim;     // sum of the products
+
+  double *re;                  // FFT work, 2*CONV_BLOCK each
+  double *im;
+  float *lastL;                // the input block before this one
+  float *lastR;
+};
+
+#endif
@@ -0,0 +1,176 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// filter
+//
+// The biquad sections and circuit model described in easy_filter.hpp.
+//
+//----------------------------------------------------------------------
+
+extern "C" {
+  #include "easy_code.h"
+}
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "easy.hpp"
+#include "easy_filter.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define FILTER_Q_MIN .05
+
+//----------------------------------------------------------------------
+
+Biquad::Biquad(int type, int stages) {
+  this->type=type;
+  this->stages=stages;
+  for (int s=0;s<FILTER_STAGES;s++) {
+    z1[s][0]=0;
+    z1[s][1]=0;
+    z2[s][0]=0;
+    z2[s][1]=0;
+  }
+  set(1000.,.7071);
+}
+
+void Biquad::set(double freq, double q) {
+  if (freq<1.) {
+    freq=1.;
+  }
+  if (freq>.49*SR) {                 // just under Nyquist
+    freq=.49*SR;
+  }
+  if (q<FILTER_Q_MIN) {
+    q=FILTER_Q_MIN;
+  }
+
+  double w=2.*M_PI*freq/SR;
+  double c=cos(w);
+  double alpha=sin(w)/(2.*q);
+  double a0=1.+alpha;
+
+  switch (type) {
+    case LOWPASS:
+      b0=(1.-c)/2.;
+      b1=1.-c;
+      b2=(1.-c)/2.;
+      break;
+    case HIGHPASS:
+      b0=(1.+c)/2.;
+      b1=-(1.+c);
+      b2=(1.+c)/2.;
+      break;
+    case BANDPASS:                   // 0dB at the centre
+      b0=alpha;
+      b1=0;
+      b2=-alpha;
+      break;
+    default:                         // NOTCH
+      b0=1.;
+      b1=-2.*c;
+      b2=1.;
+      break;
+  }
+  a1=-2.*c;
+  a2=1.-alpha;
+
+  b0/=a0;
+  b1/=a0;
+  b2/=a0;
+  a1/=a0;
+  a2/=a0;
+}
+
+//----------------------------------------------------------------------
+// per section, x in and y out:
+//
+//   y=b0*x+z1    z1=b1*x-a1*y+z2    z2=b2*x-a2*y
+
+#ifdef __SSE2__
+
+void Biquad::process(float *l, float *r, uint32_t n) {
+  const __m128d vb0=_mm_set1_pd(b0);
+  const __m128d vb1=_mm_set1_pd(b1);
+  const __m128d vb2=_mm_set1_pd(b2);
+  const __m128d va1=_mm_set1_pd(a1);
+  const __m128d va2=_mm_set1_pd(a2);
+  __m128d s1[FILTER_STAGES];
+  __m128d s2[FILTER_STAGES];
+
+  for (int s=0;s<stages;s++) {
+    s1[s]=_mm_loadu_pd(z1[s]);
+    s2[s]=_mm_loadu_pd(z2[s]);
+  }
+
+  for (uint32_t i=0;i<n;i++) {
+    __m128d x=_mm_set_pd(r[i],l[i]);
+    for (int s=0;s<stages;s++) {
+      __m128d y=_mm_add_pd(_mm_mul_pd(vb0,x),s1[s]);
+      s1[s]=_mm_add_pd(_mm_sub_pd(_mm_mul_pd(vb1,x),_mm_mul_pd(va1,y)),s2[s]);
+      s2[s]=_mm_sub_pd(_mm_mul_pd(vb2,x),_mm_mul_pd(va2,y));
+      x=y;
+    }
+    l[i]=_mm_cvtsd_f64(x);
+    r[i]=_mm_cvtsd_f64(_mm_unpackhi_pd(x,x));
+  }
+
+  for (int s=0;s<stages;s++) {
+    _mm_storeu_pd(z1[s],s1[s]);
+    _mm_storeu_pd(z2[s],s2[s]);
+  }
+}
+
+#else
+
+void Biquad::process(float *l, float *r, uint32_t n) {
+  for (uint32_t i=0;i<n;i++) {
+    double x[2]={l[i],r[i]};
+    for (int s=0;s<stages;s++) {
+      for (int c=0;c<2;c++) {
+        double y=b0*x[c]+z1[s][c];
+        z1[s][c]=b1*x[c]-a1*y+z2[s][c];
+        z2[s][c]=b2*x[c]-a2*y;
+        x[c]=y;
+      }
+    }
+    l[i]=x[0];
+    r[i]=x[1];
+  }
+}
+
+#endif
+
+//----------------------------------------------------------------------
+// CircuitStage
+
+CircuitStage::CircuitStage(void) {
+  zero();
+}
+
+void CircuitStage::zero(void) {
+  last=0;
+  integral=0;
+}
+
+// clipping limits are important: without them a big step can wind
+// the integral up and the output runs away
+
+void CircuitStage::run(float *v, uint32_t n, double cirp, double ciri, float limit) {
+  for (uint32_t k=0;k<n;k++) {
+    double delta=v[k]-last;
+    integral+=delta;
+
+    double out=delta*cirp+ciri*integral+last;
+    if (out>limit) {
+      out=limit;
+    }
+    if (out<-limit) {
+      out=-limit;
+    }
+    last=out;
+    v[k]=out;
+  }
+}
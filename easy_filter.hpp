@@ -0,0 +1,79 @@
+//----------------------------------------------------------------------
+// Filters: biquads for the filter after-effect, and the circuit
+// model used by sounds with circuit on and by the circuit
+// after-effect.
+//
+// A biquad is the usual two pole, two zero section, with the
+// coefficients from the Audio EQ Cookbook (R. Bristow-Johnson) for
+// lowpass, highpass, bandpass and notch. stages of them one after
+// another, all with the same coefficients, give a steeper slope:
+// 12dB/octave each for lowpass and highpass.
+//
+// The coefficients are worked out again each time set is called,
+// which is once a block, so cutoff and Q can follow a NumberDriver
+// without a sin and cos per sample. Each section is run in
+// transposed direct form II, which copes best with coefficients
+// changing under it.
+//
+// Left and right have the same coefficients and run side by side as
+// the two lanes of an SSE2 vector. The scalar version does the same
+// operations in the same order and gives exactly the same numbers.
+
+#ifndef EASY_FILTER_HPP
+#define EASY_FILTER_HPP 1
+
+#include <stdint.h>
+
+#define FILTER_STAGES 8            // most sections one filter can have
+
+//----------------------------------------------------------------------
+// type is LOWPASS, HIGHPASS, BANDPASS or NOTCH (easy_code.h)
+
+class Biquad {
+public:
+  int type;
+  int stages;
+
+  Biquad(int type=BANDPASS, int stages=1);
+
+  // cutoff (centre for bandpass and notch) in Hz, and Q. .7071 is
+  // the flattest lowpass or highpass without a bump.
+
+  void set(double freq, double q);
+
+  // n frames, filtered in place
+
+  void process(float *l, float *r, uint32_t n);
+
+private:
+  double b0, b1, b2, a1, a2;   // divided through by a0
+  double z1[FILTER_STAGES][2]; // state per section, L and R
+  double z2[FILTER_STAGES][2];
+};
+
+//----------------------------------------------------------------------
+// A simple circuit model to mimic the effects of capacitance and
+// inductance in the oscillator behaviour: the output chases the
+// demanded value with a proportional (cirp) and an integral (ciri)
+// term, so edges overshoot and ring.
+//
+//   d=x-y'   sum+=d   y=y'+cirp*d+ciri*sum   then clipped to +/-limit
+//
+// with y' the last output. Between the clipping it is a plain IIR
+// filter with two state values. It runs on a block of float
+// samples in place, on the same scale as the output (+/-MAXVAL),
+// with cirp and ciri held for the block.
+
+class CircuitStage {
+public:
+  CircuitStage(void);
+
+  void zero(void);
+  void run(float *v, uint32_t n, double cirp, double ciri, float limit);
+
+private:
+  double last;
+  double integral;
+};
+
+#endif
@@ -0,0 +1,267 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// jobs
+//
+// The job graph and thread pool described in easy_jobs.hpp.
+//
+// Everything here except the workers runs on the main thread, which
+// is the one reading the script. The workers only ever see a job's
+// own copy of the settings and drivers. masterTime, soundLengthX,
+// noiseKey and settings are thread_local, so a worker sets them from
+// the job and then calls the same doSound/doSilence as the main
+// thread would.
+//
+// The output buffers are made big enough and maxPos is moved up
+// when a job is recorded, so while jobs run nothing is reallocated
+// and maxPos is only read.
+//
+//----------------------------------------------------------------------
+
+extern "C" {
+  #include "easy_code.h"
+}
+
+#include <stdio.h>
+#include <list>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+#include "easy.hpp"
+#include "easy_wav.hpp"
+#include "easy_jobs.hpp"
+
+extern thread_local settings_struct_stacked settings;
+extern WaveWriter * wavout;
+
+void doSound(double);
+void doSilence(double);
+
+#define JOB_SOUND 1
+#define JOB_SILENCE 2
+
+struct Job {
+  int type;
+  double time;                         // masterTime when recorded
+  double length;
+  uint32_t startX;
+  uint32_t endX;
+  int chan;                            // 1 left, 2 right
+  uint32_t soundLengthX;
+  uint64_t noiseKey;
+  settings_struct_stacked settings;    // with the drivers below in it
+  std::vector<NumberDriver *> owned;   // driver clones, deleted after
+
+  int waiting;                         // earlier jobs still to finish
+  std::vector<Job *> after;            // jobs waiting on this one
+};
+
+// all of this belongs to the pool and is only touched under lock.
+// It is allocated once and never freed so exit() can be called with
+// the workers still waiting.
+
+struct JobPool {
+  std::mutex lock;
+  std::condition_variable wake;        // a job is ready
+  std::condition_variable idle;        // active has emptied
+  std::list<Job *> ready;
+  std::list<Job *> active;             // recorded and not finished
+};
+
+static JobPool *pool=NULL;
+
+//----------------------------------------------------------------------
+// worker thread
+
+static void runJob(Job *j) {
+  settings=j->settings;
+  masterTime=j->time;
+  soundLengthX=j->soundLengthX;
+  noiseKey=j->noiseKey;
+
+  if (j->type==JOB_SOUND) {
+    doSound(j->length);
+  }
+  else {
+    doSilence(j->length);
+  }
+}
+
+static void jobWorker(void) {
+  std::unique_lock<std::mutex> lock(pool->lock);
+
+  while (true) {
+    while (pool->ready.empty()) {
+      pool->wake.wait(lock);
+    }
+    Job *j=pool->ready.front();
+    pool->ready.pop_front();
+
+    lock.unlock();
+    runJob(j);
+    lock.lock();
+
+    for (Job *a : j->after) {
+      a->waiting--;
+      if (a->waiting==0) {
+        pool->ready.push_back(a);
+        pool->wake.notify_one();
+      }
+    }
+    pool->active.remove(j);
+    if (pool->active.empty()) {
+      pool->idle.notify_all();
+    }
+
+    for (NumberDriver *nd : j->owned) {
+      delete nd;
+    }
+    delete j;
+  }
+}
+
+//----------------------------------------------------------------------
+
+void jobsStart(int threads) {
+  if (threads<2) {
+    threads=std::thread::hardware_concurrency();
+  }
+  if (threads<1) {
+    threads=1;
+  }
+  // the wavetables are built on first use, which mustn't happen on
+  // two workers at once
+
+  waveTable(WF_SAW);
+  waveTable(WF_TRI);
+
+  pool=new JobPool;
+  for (int i=0;i<threads;i++) {
+    std::thread(jobWorker).detach();
+  }
+  printf("%sRunning independent commands on %d threads.\n%s",CYN,threads,WHT);
+}
+
+void jobsWait(void) {
+  if (pool==NULL) {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(pool->lock);
+  while (!pool->active.empty()) {
+    pool->idle.wait(lock);
+  }
+}
+
+//----------------------------------------------------------------------
+// fill in where a job goes from the current settings
+
+static Job * newJob(int type, double length) {
+  Job *j=new Job;
+
+  j->type=type;
+  j->time=masterTime;
+  j->length=length;
+  j->startX=wavout->findPosition(masterTime);
+  j->endX=wavout->findPosition(masterTime+length);
+  j->chan=(settings.left ? 1 : 0) | (settings.right ? 2 : 0);
+  j->soundLengthX=soundLengthX;
+  j->noiseKey=noiseKey;
+  j->settings.left=settings.left;
+  j->settings.right=settings.right;
+  j->waiting=0;
+  return j;
+}
+
+// hook the job in behind any earlier one it overlaps, then let it go
+
+static void submit(Job *j) {
+  if ((j->endX>0) && ((long) j->endX-1>=wavout->size)) {
+    jobsWait();                        // nothing may be writing
+    wavout->checkSize(j->endX-1);
+  }
+  if (j->endX>wavout->maxPos) {
+    wavout->maxPos=j->endX;
+  }
+
+  std::unique_lock<std::mutex> lock(pool->lock);
+
+  for (Job *a : pool->active) {
+    if ((a->chan&j->chan) && (a->startX<j->endX) && (j->startX<a->endX)) {
+      j->waiting++;
+      a->after.push_back(j);
+    }
+  }
+  pool->active.push_back(j);
+  if (j->waiting==0) {
+    pool->ready.push_back(j);
+    pool->wake.notify_one();
+  }
+}
+
+//----------------------------------------------------------------------
+
+void jobSound(double length) {
+  if (pool==NULL) {
+    doSound(length);
+    return;
+  }
+
+  NumberDriver *freqFD=settings.freqStack.top();
+  NumberDriver *phaseFD=settings.phaseStack.top();
+  NumberDriver *dutyFD=settings.dutyStack.top();
+  int form=settings.formStack.top();
+
+  Job *j=newJob(JOB_SOUND,length);
+
+  // shape (and a shape used as duty) takes its length from the first
+  // sound it is used in, so that has to happen to the original
+
+  settings.shape->init(soundLengthX);
+  dutyFD->init(soundLengthX);
+
+  // copy the drivers as one group so any shared between them stay
+  // shared (see cloneDriver). The circuit ones aren't touched unless
+  // the circuit is on.
+
+  std::map<NumberDriver *,NumberDriver *> memo;
+  cloneMemo=&memo;
+
+  settings_struct_stacked &js=j->settings;
+  js.freqStack.push(cloneDriver(freqFD));
+  js.phaseStack.push(cloneDriver(phaseFD));
+  js.dutyStack.push(cloneDriver(dutyFD));
+  js.formStack.push(form);
+  js.freq2=cloneDriver(settings.freq2);
+  js.freq3=cloneDriver(settings.freq3);
+  js.vol=cloneDriver(settings.vol);
+  js.vol2=cloneDriver(settings.vol2);
+  js.vol3=cloneDriver(settings.vol3);
+  js.bal=cloneDriver(settings.bal);
+  js.shape=cloneDriver(settings.shape);
+  js.automix=settings.automix;
+  js.fadein=settings.fadein;
+  js.fadeout=settings.fadeout;
+  js.circuit=settings.circuit;
+  js.cirp=settings.circuit ? cloneDriver(settings.cirp) : settings.cirp;
+  js.ciri=settings.circuit ? cloneDriver(settings.ciri) : settings.ciri;
+  for (Partial p : settings.partials) {
+    p.freq=cloneDriver(p.freq);
+    p.amp=cloneDriver(p.amp);
+    js.partials.push_back(p);
+  }
+  js.chord=settings.chord;
+
+  cloneMemo=NULL;
+  for (std::map<NumberDriver *,NumberDriver *>::iterator it=memo.begin();it!=memo.end();it++) {
+    j->owned.push_back(it->second);
+  }
+
+  submit(j);
+}
+
+void jobSilence(double length) {
+  if (pool==NULL) {
+    doSilence(length);
+    return;
+  }
+  submit(newJob(JOB_SILENCE,length));
+}
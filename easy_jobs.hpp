@@ -0,0 +1,27 @@
+//----------------------------------------------------------------------
+// Running independent commands at the same time (-g).
+//
+// Scripts often lay down layers that have nothing to do with each
+// other: the left channel, then "time 0" and the right channel, or
+// separate stretches of time. Normally each SOUND is rendered before
+// the next line is read.
+//
+// With -g a SOUND or SILENCE is instead recorded as a job: where it
+// goes (time range and channels) and a copy of the settings it was
+// given, with its own clones of the NumberDrivers. A job has to wait
+// for any earlier job that writes to the same channel over an
+// overlapping range; anything else goes straight to a pool of
+// worker threads.
+//
+// MIX, BOOST and REVERB read back what is already there so they wait
+// for everything before them and run in order, as before.
+
+#ifndef EASY_JOBS_HPP
+#define EASY_JOBS_HPP 1
+
+void jobsStart(int threads);       // turns the job mode on
+void jobSound(double length);      // doSound(length) or a job
+void jobSilence(double length);    // doSilence(length) or a job
+void jobsWait(void);               // until every job so far is done
+
+#endif
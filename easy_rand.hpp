@@ -0,0 +1,53 @@
+//----------------------------------------------------------------------
+// Random numbers for NOISE and randseq.
+//
+// rand() hands out one sequence to the whole program, so a value
+// depends on everything that drew before it: sounds using it can't
+// be split over threads or rendered twice and come out the same.
+// Here a random value is instead a pure function of a key and an
+// index, with the key made from the script's seed and a stream
+// number (one per randseq and one per sound). Any sample can be
+// worked out on its own, in any order, on any thread.
+//
+// The mixing is the SplitMix64 finaliser (Steele, Lea and Flood)
+// applied to key+index*gamma, which is also how SplitMix64 steps, so
+// consecutive indexes give the same quality as its sequence.
+
+#ifndef EASY_RAND_HPP
+#define EASY_RAND_HPP 1
+
+#include <stdint.h>
+
+#define RAND_GAMMA 0x9e3779b97f4a7c15ULL
+
+// script numbers are floats, so this is the largest seed a script can
+// give exactly. The seed taken from the time is kept under it too, so
+// the one printed can be given back.
+
+#define SEED_MAX 16777216
+
+extern uint64_t randSeed;          // the seed command, or the time
+uint64_t newRandKey(void);         // key for the next stream
+
+inline uint64_t randBits(uint64_t key, uint64_t index) {
+  uint64_t z=key+(index+1)*RAND_GAMMA;
+  z=(z^(z>>30))*0xbf58476d1ce4e5b9ULL;
+  z=(z^(z>>27))*0x94d049bb133111ebULL;
+  return z^(z>>31);
+}
+
+// 0 to 1 (not quite 1), from the top 53 bits
+
+inline double randUnit(uint64_t key, uint64_t index) {
+  return (randBits(key,index)>>11)*(1./9007199254740992.);
+}
+
+// out[i]=-1 to 1 for indexes from..from+n-1
+
+inline void randBlock(uint64_t key, uint64_t from, double *out, uint32_t n) {
+  for (uint32_t i=0;i<n;i++) {
+    out[i]=randUnit(key,from+i)*2.-1.;
+  }
+}
+
+#endif
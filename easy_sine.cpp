@@ -0,0 +1,159 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// sine
+//
+// Block sine kernels used by doSound and OSC. The maths is described
+// in easy_sine.hpp; here the same steps are written out for SSE2 (2
+// doubles at a time), AVX2 (4) and AVX-512 (8). Each one finishes the
+// odd samples at the end of a block with the scalar sineCycle.
+//
+// The wide versions are compiled with target attributes so the rest
+// of the program does not need -mavx and still runs on any x86-64.
+// sineInit asks the CPU (cpuid, through gcc's __builtin_cpu_supports)
+// which ones it can run and picks the widest.
+//
+// On anything that isn't x86 only the scalar version is built.
+//
+//----------------------------------------------------------------------
+
+#include <stdio.h>
+
+#include "easy_sine.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SINE_X86 1
+#endif
+
+//----------------------------------------------------------------------
+// plain C version, used when nothing better is available
+
+static void sineBlockScalar(const double *cyc, double *out, uint32_t n) {
+  for (uint32_t i=0;i<n;i++) {
+    out[i]=sineCycle(cyc[i]);
+  }
+}
+
+#ifdef SINE_X86
+
+//----------------------------------------------------------------------
+// SSE2 is part of x86-64 so this one is always there
+
+__attribute__((target("sse2")))
+static void sineBlockSSE2(const double *cyc, double *out, uint32_t n) {
+  const __m128d rounder=_mm_set1_pd(SINE_ROUNDER);
+  const __m128d half=_mm_set1_pd(.5);
+  const __m128d mhalf=_mm_set1_pd(-.5);
+  uint32_t i=0;
+
+  for (;i+2<=n;i+=2) {
+    __m128d c=_mm_loadu_pd(cyc+i);
+    __m128d r=_mm_sub_pd(c,_mm_sub_pd(_mm_add_pd(c,rounder),rounder));
+    __m128d f=_mm_min_pd(r,_mm_sub_pd(half,r));
+    f=_mm_max_pd(f,_mm_sub_pd(mhalf,f));
+    __m128d f2=_mm_mul_pd(f,f);
+    __m128d p=_mm_set1_pd(SINE_C13);
+    p=_mm_add_pd(_mm_mul_pd(p,f2),_mm_set1_pd(SINE_C11));
+    p=_mm_add_pd(_mm_mul_pd(p,f2),_mm_set1_pd(SINE_C9));
+    p=_mm_add_pd(_mm_mul_pd(p,f2),_mm_set1_pd(SINE_C7));
+    p=_mm_add_pd(_mm_mul_pd(p,f2),_mm_set1_pd(SINE_C5));
+    p=_mm_add_pd(_mm_mul_pd(p,f2),_mm_set1_pd(SINE_C3));
+    p=_mm_add_pd(_mm_mul_pd(p,f2),_mm_set1_pd(SINE_C1));
+    _mm_storeu_pd(out+i,_mm_mul_pd(p,f));
+  }
+  for (;i<n;i++) {
+    out[i]=sineCycle(cyc[i]);
+  }
+}
+
+//----------------------------------------------------------------------
+// AVX2, 4 at a time. FMA is deliberately not used so the results
+// match the other versions bit for bit.
+
+__attribute__((target("avx2")))
+static void sineBlockAVX2(const double *cyc, double *out, uint32_t n) {
+  const __m256d rounder=_mm256_set1_pd(SINE_ROUNDER);
+  const __m256d half=_mm256_set1_pd(.5);
+  const __m256d mhalf=_mm256_set1_pd(-.5);
+  uint32_t i=0;
+
+  for (;i+4<=n;i+=4) {
+    __m256d c=_mm256_loadu_pd(cyc+i);
+    __m256d r=_mm256_sub_pd(c,_mm256_sub_pd(_mm256_add_pd(c,rounder),rounder));
+    __m256d f=_mm256_min_pd(r,_mm256_sub_pd(half,r));
+    f=_mm256_max_pd(f,_mm256_sub_pd(mhalf,f));
+    __m256d f2=_mm256_mul_pd(f,f);
+    __m256d p=_mm256_set1_pd(SINE_C13);
+    p=_mm256_add_pd(_mm256_mul_pd(p,f2),_mm256_set1_pd(SINE_C11));
+    p=_mm256_add_pd(_mm256_mul_pd(p,f2),_mm256_set1_pd(SINE_C9));
+    p=_mm256_add_pd(_mm256_mul_pd(p,f2),_mm256_set1_pd(SINE_C7));
+    p=_mm256_add_pd(_mm256_mul_pd(p,f2),_mm256_set1_pd(SINE_C5));
+    p=_mm256_add_pd(_mm256_mul_pd(p,f2),_mm256_set1_pd(SINE_C3));
+    p=_mm256_add_pd(_mm256_mul_pd(p,f2),_mm256_set1_pd(SINE_C1));
+    _mm256_storeu_pd(out+i,_mm256_mul_pd(p,f));
+  }
+  for (;i<n;i++) {
+    out[i]=sineCycle(cyc[i]);
+  }
+}
+
+//----------------------------------------------------------------------
+// AVX-512, 8 at a time
+
+__attribute__((target("avx512f")))
+static void sineBlockAVX512(const double *cyc, double *out, uint32_t n) {
+  const __m512d rounder=_mm512_set1_pd(SINE_ROUNDER);
+  const __m512d half=_mm512_set1_pd(.5);
+  const __m512d mhalf=_mm512_set1_pd(-.5);
+  uint32_t i=0;
+
+  for (;i+8<=n;i+=8) {
+    __m512d c=_mm512_loadu_pd(cyc+i);
+    __m512d r=_mm512_sub_pd(c,_mm512_sub_pd(_mm512_add_pd(c,rounder),rounder));
+    __m512d f=_mm512_min_pd(r,_mm512_sub_pd(half,r));
+    f=_mm512_max_pd(f,_mm512_sub_pd(mhalf,f));
+    __m512d f2=_mm512_mul_pd(f,f);
+    __m512d p=_mm512_set1_pd(SINE_C13);
+    p=_mm512_add_pd(_mm512_mul_pd(p,f2),_mm512_set1_pd(SINE_C11));
+    p=_mm512_add_pd(_mm512_mul_pd(p,f2),_mm512_set1_pd(SINE_C9));
+    p=_mm512_add_pd(_mm512_mul_pd(p,f2),_mm512_set1_pd(SINE_C7));
+    p=_mm512_add_pd(_mm512_mul_pd(p,f2),_mm512_set1_pd(SINE_C5));
+    p=_mm512_add_pd(_mm512_mul_pd(p,f2),_mm512_set1_pd(SINE_C3));
+    p=_mm512_add_pd(_mm512_mul_pd(p,f2),_mm512_set1_pd(SINE_C1));
+    _mm512_storeu_pd(out+i,_mm512_mul_pd(p,f));
+  }
+  for (;i<n;i++) {
+    out[i]=sineCycle(cyc[i]);
+  }
+}
+
+#endif
+
+//----------------------------------------------------------------------
+// dispatch
+
+void (*sineBlock)(const double *cyc, double *out, uint32_t n)=sineBlockScalar;
+
+static const char * sineName="scalar";
+
+void sineInit(void) {
+#ifdef SINE_X86
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx512f")) {
+    sineBlock=sineBlockAVX512;
+    sineName="AVX-512";
+  }
+  else if (__builtin_cpu_supports("avx2")) {
+    sineBlock=sineBlockAVX2;
+    sineName="AVX2";
+  }
+  else if (__builtin_cpu_supports("sse2")) {
+    sineBlock=sineBlockSSE2;
+    sineName="SSE2";
+  }
+#endif
+}
+
+const char * sineKernelName(void) {
+  return sineName;
+}
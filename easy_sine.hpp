@@ -0,0 +1,60 @@
+//----------------------------------------------------------------------
+// Fast sine for the render loops.
+//
+// Input is the position in the cycle (1.0 is one full turn) which is
+// what the phase accumulators hand out, so there is no 2*pi to multiply
+// in and no large radian values to reduce.
+//
+// The wave is folded onto the quarter cycle -.25..+.25 and a degree 13
+// odd polynomial (Taylor series of sin(2*pi*c)) is used there. Worst
+// case error is under 1e-9, far below one int16 step (1/32768).
+//
+// sineBlock works on a whole block at a time and is dispatched at
+// startup to the widest of AVX-512, AVX2 or SSE2 the CPU has (see
+// sineInit). All versions do the same operations in the same order
+// with no FMA, so they give exactly the same numbers as sineCycle.
+
+#ifndef EASY_SINE_HPP
+#define EASY_SINE_HPP 1
+
+#include <stdint.h>
+
+// coefficients are (2*pi)^k/k! with alternating sign
+
+#define SINE_C1   6.283185307179586
+#define SINE_C3  -41.341702240399755
+#define SINE_C5   81.60524927607504
+#define SINE_C7  -76.70585975306136
+#define SINE_C9   42.058693944897634
+#define SINE_C11 -15.094642576822984
+#define SINE_C13  3.8199525848482803
+
+// adding and subtracting 1.5*2^52 rounds a double to the nearest
+// integer without needing SSE4.1 round instructions
+
+#define SINE_ROUNDER 6755399441055744.0
+
+inline double sineCycle(double c) {
+  double r=c-((c+SINE_ROUNDER)-SINE_ROUNDER);   // -.5 to .5
+  double f=(r<(.5-r)) ? r : (.5-r);              // fold top quarter
+  double g=-.5-f;
+  f=(f>g) ? f : g;                               // fold bottom quarter
+  double f2=f*f;
+  double p=SINE_C13;
+  p=p*f2+SINE_C11;
+  p=p*f2+SINE_C9;
+  p=p*f2+SINE_C7;
+  p=p*f2+SINE_C5;
+  p=p*f2+SINE_C3;
+  p=p*f2+SINE_C1;
+  return p*f;
+}
+
+// out[i]=sin(2*pi*cyc[i]) for i=0..n-1
+
+extern void (*sineBlock)(const double *cyc, double *out, uint32_t n);
+
+void sineInit(void);
+const char * sineKernelName(void);
+
+#endif
@@ -25,6 +25,13 @@
 
 #define LOW_FREQ_LIMIT 30
 
+#define PINK_ROWS 16            // pink goes down to SR/2^16, under 1Hz
+#define BROWN_CORNER 10.        // Hz, brown levels off below this
+#define BAND_Q 1.41             // bandnoise is about an octave wide
+#define NOISE_RMS .144          // the coloured noises are all this loud
+
+#define BANK_OSC ((BANK_PARTIALS+2)*BANK_VOICES)   // +2 for freq2, freq3
+
 extern "C" {
   #include "easy_code.h"
 }
@@ -34,119 +41,23 @@ extern "C" {
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <thread>
+#include <vector>
 
 #include "easy.hpp"
 #include "easy_wav.hpp"
 #include "easy_node.hpp"
+#include "easy_fft.hpp"
+#include "easy_fdn.hpp"
+#include "easy_filter.hpp"
 
-extern settings_struct_stacked settings;
+extern thread_local settings_struct_stacked settings;
 extern WaveWriter * wavout;
 extern long defaultFormat;
 extern const char * defaultFileout;
 
 extern uint32_t SR;
-
-uint32_t periodX;
-uint32_t dutyX;
-double sawslope;
-double trislope;
-uint32_t waitX;
-double freq;
-uint32_t tensX;
-double dutyThresh;
-
-//----------------------------------------------------------------------
-// This is a simple circuit model to mimic the effects of
-// capacitance and inductance in the oscillator behaviour.
-// 
-// For an idealized signal, turn this off. (default)
-//
-// For more complex waveforms, with additional harmonics,
-// provide a proportional and integral term. Cautious values
-// will be provided as defaults in cirp and ciri settings.
-
-class Circuit {
-
-public:
-
-  double propFactor;
-  double intFactor;
-
-  int32_t delta=0;    
-  int32_t Factor=0;
-  int32_t integral;
-
-  int32_t last=0;
-  int32_t lastDemanded=0;
-  int32_t lag;
-  long output;
-
-  Circuit (void) {
-    integral=0;
-    last=0;
-  }
-
-  //----------------------------------------------------------------------
-  // input is the current demanded value
-  // output is the deviation due to simulated circuit imperfection
-  // caused 
-
-  int32_t effect(uint32_t x,int32_t demanded) {
-
-    propFactor=settings.cirp->getValue(x);
-    intFactor=settings.ciri->getValue(x);
-    // printf("circuit: %d propFactor %f %f\n",x,propFactor,intFactor);
-
-    delta=demanded-last;
-
-    integral+=delta;
-
-    int32_t term1=delta*propFactor;
-    int32_t term2=intFactor*integral;
-
-    
-    output=term1+term2+last;
-
-    // clipping limits are important for a few reasons
-    // caution here: C/C++ compiler is blind to sign/non-signed integer
-    // comparisons so this has to be coded oddly
-    
-    if (output>wavout->MAXVAL) {
-      output=wavout->MAXVAL;
-    }
-    if (output<-float(wavout->MAXVAL)) {
-      output=-int(float(wavout->MAXVAL));
-    }
-    
-    last=output;
-    lastDemanded=demanded;
-
-    // printf("circuit: last %d demanded %5d change %5d  %5d+%5d+%5d=%5d\n",last,demanded,delta,term1,term2,last,output);
-    
-    return output;
-  }
-
-  void zero (void) {
-    integral=0;
-    last=0;
-    lastDemanded=0;
-  }
-
-};
-
-//----------------------------------------------------------------------
-// updatePeriods recalcuates certain parameters that
-// are used in the waveform generation based on frequency.
-// Collected in one place for simplicity in mainline code.
-//
-  
-void updatePeriods(void) {
-  periodX=int(SR/freq);
-  dutyX=int(SR/freq)*dutyThresh; 
-  sawslope=1./dutyX;
-  trislope=2./dutyX;
-  waitX=(periodX-dutyX)/2;
-}
+extern "C" int flagJobs;
 
 // this need an explanation: ramp gets processed before the sound
 // length is known. But we don't want to make a special interface
@@ -157,64 +68,7 @@ void updatePeriods(void) {
 //
 // Note that this (at present) apply to after-effects.
 
-extern uint32_t soundLengthX;
-
-//----------------------------------------------------------------------
-// Does fadein-effect
-//
-// This is enabled by default as it is desirable for most signals.
-
-double calcFadein (double x) {
-  // initialize
-  static long fadecounter;
-  static long fadeends;
-  double fade1;
-
-  if (x==0) {  // trigger at the start of each new sound
-    fadecounter=0;
-    fadeends=settings.fadein*SR;  // convert sec to frames
-  }
-
-  if (fadecounter<fadeends) {
-
-    fade1=float(fadecounter)/float(fadeends);
-
-    fadecounter++;
-  }
-  else {
-    fade1=1.;
-  }
-
-  return fade1;
-}
-
-//--------------------------------------------------
-// Does fadeout effect.
-//
-// Not enabled by default. It can smooth any signal
-// discontinuities or finish off the end of
-// a signal in a more natural way.
-
-double calcFadeout (uint32_t x, uint32_t startX, uint32_t endX) {
-  static long fadeout_starts=1;
-  static long spanFade=1;
-  
-  double fade2;
-  
-  if (x==0) {  // trigger at the start of each new sound
-    spanFade=settings.fadeout*SR;
-    fadeout_starts=endX-startX-spanFade;
-  }
-
-  if (x>fadeout_starts) {
-    fade2=1-(x-fadeout_starts)/float(spanFade);
-  }
-  else {
-    fade2=1.;
-  }
-
-  return fade2;
-}
+extern thread_local uint32_t soundLengthX;
 
 //----------------------------------------
 // And the vision that was planted in my brain
@@ -234,13 +88,9 @@ void doSilence (double length) {
 
   // a silence is just like a sound but with more zeros
 
+  int chan=(settings.left ? 1 : 0) | (settings.right ? 2 : 0);
   for (uint32_t x=0;x<deltaX;x++) {
-    if (settings.left) {
-      wavout->setValueL(startX+x,0,false);
-    }
-    if (settings.right) {
-      wavout->setValueR(startX+x,0,false);
-    }
+    wavout->setFrame(startX+x,0,0,chan);
   }
   
   if (endX>wavout->maxPos) {
@@ -259,7 +109,7 @@ void doBoost (double length, NumberDriver *nd) {
   uint32_t startX=wavout->findPosition(masterTime);
   double endTime=masterTime+length;
   uint32_t endX=wavout->findPosition(endTime);
-  int32_t newval;
+  int chan=(settings.left ? 1 : 0) | (settings.right ? 2 : 0);
   
   
   std::cout << MAG << "  Boost from " << masterTime << " to " << endTime << "\n" << WHT;
@@ -274,24 +124,29 @@ void doBoost (double length, NumberDriver *nd) {
   
   // left / right settings apply, as usual
   
+  double multB[BLOCK_SIZE];
+  double shapeB[BLOCK_SIZE];
   uint32_t countX=0;
-  for (uint32_t x=startX;x<endX;x++) {
-    double multiplier=nd->getValue(countX);           // multiplier can vary!
-    double shapevol=settings.shape->getValue(countX);
-    double volnet=shapevol*multiplier;
-      
-    if (settings.left) {
-      // printf("val: %d\n",wavout->getValueL(x,false));
-      newval=wavout->getValueL(x,false)*volnet;  // get numbber and make it bigger
-      // printf("newval: %d\n",newval);
-      wavout->setValueL(x,newval,false);             // write it back same spot
+  
+  for (uint32_t bx=startX;bx<endX;bx+=BLOCK_SIZE) {
+    uint32_t bn=endX-bx;
+    if (bn>BLOCK_SIZE) {
+      bn=BLOCK_SIZE;
     }
-    if (settings.right) {
-      newval=wavout->getValueR(x,false)*volnet;
-      wavout->setValueR(x,newval,false);
+    nd->getBlock(countX,bn,multB);               // multiplier can vary!
+    settings.shape->getBlock(countX,bn,shapeB);
+
+    for (uint32_t i=0;i<bn;i++) {
+      uint32_t x=bx+i;
+      double volnet=shapeB[i]*multB[i];
+      float l;
+      float r;
+
+      wavout->getFrame(x,l,r);  // get numbers and make them bigger
+      wavout->setFrame(x,l*volnet,r*volnet,chan);  // write back same spot
+      // printf("volnet: %f\n",volnet);
     }
-    countX++;
-    // printf("volnet: %f\n",volnet);
+    countX+=bn;
   }
 }
 
@@ -305,11 +160,46 @@ void doBoost (double length, NumberDriver *nd) {
 // easily saturate the signal. There is also reverb-on-the-reverb
 // as it is done forwards through time.
 //
-void doReverb (double length, NumberDriver *amt, NumberDriver *del) {
+// More echoes can be added with tap, each with its own delay and a
+// gain relative to vol:
+//
+//   reverb 20 .25 tap .4 .5 tap .7 .25
+//
+// This is a delay line that uses the output itself as its memory:
+// each frame in the span is added back in delay seconds later on
+// every tap. The span is taken a block at a time. While no tap's
+// delay is shorter than the block, nothing written is read again in
+// the same block, so the block is read once and added in one go at
+// each tap. Shorter delays go a frame at a time as before.
+//
+// Fixed delays are whole frames. A delay that varies lands between
+// frames and is shared between the two either side of it, so it
+// slides smoothly instead of stepping a frame at a time.
+
+// add l,r at pos+d on the chan channels, d in frames
+
+static inline void addDelayed(uint32_t pos, double d, float l, float r, int chan, bool fixed) {
+  uint32_t dX=d;
+  float ol;
+  float or_;
+
+  if (fixed) {
+    wavout->getFrame(pos+dX,ol,or_);
+    wavout->setFrame(pos+dX,ol+l,or_+r,chan);
+    return;
+  }
+  float f=d-dX;
+  wavout->getFrame(pos+dX,ol,or_);
+  wavout->setFrame(pos+dX,ol+l*(1-f),or_+r*(1-f),chan);
+  wavout->getFrame(pos+dX+1,ol,or_);
+  wavout->setFrame(pos+dX+1,ol+l*f,or_+r*f,chan);
+}
+
+void doReverb (double length, NumberDriver *amt, int taps, NumberDriver **del, double *gain) {
   uint32_t startX=wavout->findPosition(masterTime);
   double endTime=masterTime+length;
   uint32_t endX=wavout->findPosition(endTime);
-  int32_t val;
+  int chan=(settings.left ? 1 : 0) | (settings.right ? 2 : 0);
 
   std::cout << MAG << "  Reverb from " << masterTime << " to " << endTime << "\n" << WHT;
   
@@ -317,405 +207,1035 @@ void doReverb (double length, NumberDriver *amt, NumberDriver *del) {
     endX=wavout->maxPos;
   }
 
+  // delays that don't change are worked out once
+
+  bool fixed=true;
+  for (int t=0;t<taps;t++) {
+    if (!del[t]->isConstant()) {
+      fixed=false;
+    }
+  }
+  
   // left / right settings apply, as usual
   
+  double amountB[BLOCK_SIZE];
+  double delayB[REVERB_TAPS][BLOCK_SIZE];  // in frames
+  float srcL[BLOCK_SIZE];
+  float srcR[BLOCK_SIZE];
+  float tapL[BLOCK_SIZE];
+  float tapR[BLOCK_SIZE];
   uint32_t countX=0;
-  for (uint32_t x=startX;x<endX;x++) {
-    double amount=amt->getValue(countX);         // amount can vary and is vol parameter
-    double delayS=del->getValue(countX);          // delay can vary and is seconds
-    uint32_t delayX=delayS*SR;
-    uint32_t laterX;
-    long oldval;
-    long newval;
-    
-    if (settings.left) {
-      // printf("reverb. amt: %f del: %f \n",amount,delayS);
-      val=wavout->getValueL(x,false)*amount;  // get current value
-      laterX=x+delayX;
-      oldval=wavout->getValueL(laterX,false);  // get old value at target
-      newval=oldval+val;                              // add echo
-      wavout->setValueL(laterX,newval,false);          // echo it later
+
+  if (fixed) {
+    for (int t=0;t<taps;t++) {
+      uint32_t dX=del[t]->getValue(0)*SR;
+      for (int i=0;i<BLOCK_SIZE;i++) {
+        delayB[t][i]=dX;
+      }
+    }
+  }
+  
+  for (uint32_t bx=startX;bx<endX;bx+=BLOCK_SIZE) {
+    uint32_t bn=endX-bx;
+    if (bn>BLOCK_SIZE) {
+      bn=BLOCK_SIZE;
     }
-    if (settings.right) {
-      // printf("val: %d\n",wavout->getValueR(x,false));
-      val=int(wavout->getValueR(x,false)*amount);  // get current value
-      // printf("newval: %d\n",newval);
-      laterX=x+delayX;
-      oldval=wavout->getValueR(laterX,false);  // get old value at target
-      newval=oldval+val;                              // add echo
-      wavout->setValueR(laterX,newval,false);          // echo it later
+    amt->getBlock(countX,bn,amountB);         // amount can vary and is vol parameter
+
+    // the shortest delay decides if the block can go at once
+
+    double shortest=BLOCK_SIZE;
+    for (int t=0;t<taps;t++) {
+      if (!fixed) {
+        del[t]->getBlock(countX,bn,delayB[t]);   // delay can vary and is seconds
+        for (uint32_t i=0;i<bn;i++) {
+          delayB[t][i]*=SR;
+        }
+      }
+      for (uint32_t i=0;i<bn;i++) {
+        if (delayB[t][i]<shortest) {
+          shortest=delayB[t][i];
+        }
+      }
     }
 
-    countX++;
+    if (shortest>=bn) {
+      wavout->getBlock(bx,bn,srcL,srcR);
+      for (int t=0;t<taps;t++) {
+        if (fixed) {
+          for (uint32_t i=0;i<bn;i++) {
+            tapL[i]=srcL[i]*amountB[i]*gain[t];
+            tapR[i]=srcR[i]*amountB[i]*gain[t];
+          }
+          wavout->addBlock(bx+(uint32_t) delayB[t][0],bn,tapL,tapR,chan);
+        }
+        else {
+          for (uint32_t i=0;i<bn;i++) {
+            float valL=srcL[i]*amountB[i]*gain[t];
+            float valR=srcR[i]*amountB[i]*gain[t];
+            addDelayed(bx+i,delayB[t][i],valL,valR,chan,false);
+          }
+        }
+      }
+    }
+    else {
+      for (uint32_t i=0;i<bn;i++) {
+        uint32_t x=bx+i;
+        float l;
+        float r;
+
+        wavout->getFrame(x,l,r);  // get current value
+        for (int t=0;t<taps;t++) {
+          float valL=l*amountB[i]*gain[t];
+          float valR=r*amountB[i]*gain[t];
+          addDelayed(x,delayB[t][i],valL,valR,chan,fixed);  // add echo later
+        }
+      }
+    }
+    countX+=bn;
   }
 }
 
-//======================================================================
-// doSound
+//----------------------------------------------------------------------
+// Convolve is a reverb from an impulse response (IR): the sound a
+// room (or anything else) makes in answer to a single click. Every
+// sample of the source span sets off a copy of the IR scaled by it.
 //
-// Most of the sound generation is done here including
-// all the waveform types. From experience, I know that this code
-// can get VERY messy quickly.
+//   convolve 20 "hall.wav"    IR from a WAV file, mono or stereo
+//   convolve 20 2.5           IR made up: noise dying away by 60dB
+//                             over 2.5s, different on each side
 //
-// Some tips:
-// - variables ending in X pertain to sample locations/times in integer format
-// - be mindful of whether a sample value is in double (-1 to 1) or integer
-//   format (e.g. -32768 to -32767).
-// - coding style should be expansive (step by step) rather than condensed
-//   to facilitate debugging. (Let compiler optimizations handle speed.)
+// The IR is scaled to unit energy so vol sets the level of the
+// reverb against the dry signal, as with reverb. The dry signal is
+// left as it is and the reverb added on top, running on past the
+// span by the length of the IR.
+//
+// See easy_fft.hpp for how it is done without a multiply per IR
+// sample.
+
+// noise from a fixed seed so the same script gives the same room
+// whatever the seed command says
+
+static void decayIR(double t60, float *irL, float *irR, uint32_t len) {
+  uint32_t seed=0x2545f491;
+  double k=log(1000.)/(t60*SR);          // 60dB is 1000x
+
+  for (uint32_t i=0;i<len;i++) {
+    double env=exp(-k*i);
+    seed^=seed<<13;
+    seed^=seed>>17;
+    seed^=seed<<5;
+    irL[i]=env*((seed&0xffff)/32768.-1.);
+    irR[i]=env*((seed>>16)/32768.-1.);
+  }
+}
 
+// a WAV file IR as L and R at SR. Any other rate is brought to SR by
+// straight line interpolation, which is plenty for a reverb tail.
 
-void doSound (double length, bool scratch) {
-  double endTime=masterTime+length;
-  long startX;
-  long endX;
-  uint32_t mult=wavout->MAXVAL;
-  Circuit circuit;
-  double sineval2;
-  double sineval3;
-  int noiseCounter=0;
-  double noisePeriod=0;
+static float * fileIR(const char *filename, float *&irR, uint32_t &len) {
+  uint32_t frames;
+  int channels;
+  uint32_t rate;
+  float *wav=readWav(filename,frames,channels,rate);
 
-  std::cout << MAG << "  Sound from " << masterTime << " to " << endTime << "\n" << WHT;
+  if ((frames==0) || (rate==0)) {
+    printf("%sError - %s has no audio in it\n%s",RED,filename,WHT);
+    exit(2);
+  }
 
-  // what if no output command was ever given?
-  // initialize output buffers to default
+  double step=rate/(double) SR;
+  len=frames/step;
+  if (len>IR_MAX_SECONDS*SR) {
+    printf("%sError - %s is over %ds, too long for an IR\n%s",RED,filename,IR_MAX_SECONDS,WHT);
+    exit(2);
+  }
 
-  if (wavout==NULL) {
-      wavout=new WaveWriter(defaultFormat*60*10,defaultFormat);
+  float *irL=new float[len];
+  irR=new float[len];
+  int right=(channels>1) ? 1 : 0;       // mono goes to both
+
+  for (uint32_t i=0;i<len;i++) {
+    double at=i*step;
+    uint32_t a=at;
+    uint32_t b=(a+1<frames) ? a+1 : a;
+    double f=at-a;
+    irL[i]=(1-f)*wav[a*channels]+f*wav[b*channels];
+    irR[i]=(1-f)*wav[a*channels+right]+f*wav[b*channels+right];
   }
-  
-  // std::cout << "Play a sound from " << masterTime << " to " << endTime << "\n";
+  delete[] wav;
+  return irL;
+}
 
-  startX=wavout->findPosition(masterTime);
-  endX=wavout->findPosition(endTime);
-  soundLengthX=length*SR;     // needed for shape and ramp which can repeat
+void doConvolve (double length, NumberDriver *amt, const char *irFile, double decay) {
+  uint32_t startX=wavout->findPosition(masterTime);
+  double endTime=masterTime+length;
+  uint32_t endX=wavout->findPosition(endTime);
+  int chan=(settings.left ? 1 : 0) | (settings.right ? 2 : 0);
+  float *irL;
+  float *irR;
+  uint32_t irLen;
 
-  // initialize shape if it is being used and not already set
+  if (irFile!=NULL) {
+    irL=fileIR(irFile,irR,irLen);
+  }
+  else {
+    irLen=decay*SR;
+    irL=new float[irLen];
+    irR=new float[irLen];
+    decayIR(decay,irL,irR,irLen);
+  }
 
-  settings.shape->init(soundLengthX);
-  
-  // setup work...
-  // NumberDrivers to strange stuff when you don't init them
-  
-  NumberDriver * freqFD=settings.freqStack.top();
-  NumberDriver * phaseFD=settings.phaseStack.top();
-  int form=settings.formStack.top();
-  NumberDriver * dutyFD=settings.dutyStack.top();  
+  double energy=0;
+  for (uint32_t i=0;i<irLen;i++) {
+    energy+=((double) irL[i]*irL[i]+(double) irR[i]*irR[i])/2.;
+  }
+  if (energy>0) {
+    float scale=1./sqrt(energy);
+    for (uint32_t i=0;i<irLen;i++) {
+      irL[i]*=scale;
+      irR[i]*=scale;
+    }
+  }
 
-  // initialize shape if it is being used and not already set
+  Convolver conv(irL,irR,irLen);
+  delete[] irL;
+  delete[] irR;
 
-  dutyFD->init(soundLengthX);  // needs initializing, I guess
-  
-  freqFD->init(0);                  
-  phaseFD->init(0);                  
-  settings.freq2->init(0);                  
-  settings.freq3->init(0);                  
-  settings.bal->init(0);
-  settings.vol->init(0);
-  settings.vol2->init(0);
-  settings.vol3->init(0);
-    
-  freq=freqFD->getValue(0);        // get frequency setting
-  uint32_t freqRefX=0;                    // starting point for calc freq
-  circuit.zero();                        // clear any history in Circuit model
+  std::cout << MAG << "  Convolve from " << masterTime << " to " << endTime << " IR " << irLen/(double) SR << "s in " << conv.parts << " parts\n" << WHT;
 
-  // generation work...
+  if (endX>wavout->maxPos) {  // limit our action to the current output range
+    endX=wavout->maxPos;
+  }
+  uint32_t tailX=endX+irLen;    // the last of the reverb
 
-  uint32_t deltaX=endX-startX;
-  double lastval=0.0;
-  double lastfreq=freq;
+  amt->init(0);
 
-  updatePeriods();  
-  
-  // this counts the step in a cycle
-  // we'll try and reuse it for various
-  // types of waveforms.
-  
-  uint32_t countX=0;   
-  uint32_t countXadj=0;  // adjusted for phase
+  float *inL=new float[CONV_BLOCK];
+  float *inR=new float[CONV_BLOCK];
+  float *outL=new float[CONV_BLOCK];
+  float *outR=new float[CONV_BLOCK];
+  double amountB[BLOCK_SIZE];
 
-  for (uint32_t x=0;x<deltaX;x++) {
-    countX++;
+  // each block is read before anything is added to it, so the reverb
+  // is always of the dry signal
 
-    // current phase percent and frames...
-    // e.g. -.3*44100/1000 = -13 frames ... range would be -22 to +22
-    //
-    // easyV1 had some hellish code to do phasors at various speeds
-    // and to limit adjustment speed. We're relying on phasors being
-    // driven by oscillators to hopefully make this unnecessary.
-    
-    double phase=phaseFD->getValue(x);
-    int32_t phaseX=phase*SR/freq;
-    noisePeriod=SR/freq;     // period to change noise signal
+  for (uint32_t cx=startX;cx<tailX;cx+=CONV_BLOCK) {
+    for (uint32_t i=0;i<CONV_BLOCK;i++) {
+      uint32_t x=cx+i;
+      if (x<endX) {
+        wavout->getFrame(x,inL[i],inR[i]);
+      }
+      else {
+        inL[i]=0;
+        inR[i]=0;
+      }
+    }
+
+    conv.process(inL,inR,outL,outR);
 
-    countXadj=countX+phaseX;  // adjust our counter for phase
-      
-    if (countXadj>periodX) {
-      countXadj=0;
-      countX=-phaseX;
+    uint32_t cn=tailX-cx;
+    if (cn>CONV_BLOCK) {
+      cn=CONV_BLOCK;
     }
+    for (uint32_t bi=0;bi<cn;bi+=BLOCK_SIZE) {
+      uint32_t bn=cn-bi;
+      if (bn>BLOCK_SIZE) {
+        bn=BLOCK_SIZE;
+      }
+      amt->getBlock(cx-startX+bi,bn,amountB);   // amount can vary and is vol parameter
 
-    // update settings driven by NumberDrivers and other settings
+      for (uint32_t i=0;i<bn;i++) {
+        uint32_t x=cx+bi+i;
+        float l;
+        float r;
 
-    double fadein=calcFadein(x);
-    double fadeout=calcFadeout(x,startX,endX);
+        wavout->getFrame(x,l,r);
+        wavout->setFrame(x,l+amountB[i]*outL[bi+i],r+amountB[i]*outR[bi+i],chan);
+      }
+    }
+  }
 
-    // effective volume...
-    //
-    // BUG here... phase should be affecting these as well
-    // but this is the phase of their numberDrivers,
-    // not the phase of the waveform (nested oscillators).
-    //
-    // this is the problem:
-    // sound 10 phase .2 vol osc .5 to 1 freq 1p phase .5
-    //
-    // the first phase .2 affects the sine wave itself
-    // the second phase .5 affects the volume modifier
-    //
-    // I think the answer is to handle it down in the NumberDriver. And I guess
-    // this could stack deeper, but the uses get harder to justify.
+  delete[] inL;
+  delete[] inR;
+  delete[] outL;
+  delete[] outR;
+}
 
-    double shapevol=settings.shape->getValue(x);
-    double vol=abs(settings.vol->getValue(x));
-    double volnet=fadein*fadeout*shapevol;
-    double vol2=abs(settings.vol2->getValue(x));
-    double vol3=abs(settings.vol3->getValue(x));
-    double freq2=abs(settings.freq2->getValue(x));
-    double freq3=abs(settings.freq3->getValue(x));
+//----------------------------------------------------------------------
+// Room is an algorithmic reverb, a feedback delay network (see
+// easy_fdn.hpp). It gives a dense tail like convolve with a made up
+// IR for far less work, and decay and size can change as it runs.
+//
+//   room 20 2.5               t60 of 2.5s in a room of size 1
+//   room 20 2.5 size 2        twice as big: echoes further apart
+//
+// decay and size are read each block. As with convolve, vol is the
+// level of the reverb against the dry signal, the dry signal is left
+// alone and the tail runs on past the span for the t60.
 
-    if ((vol>0) && (freq<LOW_FREQ_LIMIT)) {
-      printf("%sError - freq %fHz below low safety limit of %d\n%s",RED,freq, LOW_FREQ_LIMIT,WHT);
-      exit(2);
+void doRoom (double length, NumberDriver *amt, NumberDriver *decay, NumberDriver *size) {
+  uint32_t startX=wavout->findPosition(masterTime);
+  double endTime=masterTime+length;
+  uint32_t endX=wavout->findPosition(endTime);
+  int chan=(settings.left ? 1 : 0) | (settings.right ? 2 : 0);
+
+  std::cout << MAG << "  Room from " << masterTime << " to " << endTime << "\n" << WHT;
+
+  if (endX>wavout->maxPos) {  // limit our action to the current output range
+    endX=wavout->maxPos;
+  }
+
+  amt->init(0);
+  decay->init(0);
+  size->init(0);
+
+  Fdn fdn;
+  double amountB[BLOCK_SIZE];
+  double decayB[BLOCK_SIZE];
+  double sizeB[BLOCK_SIZE];
+  float inL[BLOCK_SIZE];
+  float inR[BLOCK_SIZE];
+  float outL[BLOCK_SIZE];
+  float outR[BLOCK_SIZE];
+  uint32_t tailX=0;           // set at the end of the span
+  uint32_t countX=0;
+
+  // each block is read before anything is added to it, so the reverb
+  // is always of the dry signal
+
+  for (uint32_t bx=startX;;bx+=BLOCK_SIZE) {
+    if ((bx>=endX) && (tailX==0)) {
+      tailX=endX+fdn.t60*SR;
     }
-    if ((vol2>0) && (freq2<LOW_FREQ_LIMIT)) {
-      printf("%sError - freq2 %fHz below low safety limit of %d\n%s",RED, freq2, LOW_FREQ_LIMIT,WHT);
-      exit(2);
+    if ((tailX!=0) && (bx>=tailX)) {
+      break;
     }
-    if ((vol3>0)&& (freq3<LOW_FREQ_LIMIT)) {
-      printf("%sError - freq3 %fHz below low safety limit of %d\n%s",RED, freq3, LOW_FREQ_LIMIT,WHT);
-      exit(2);
+    uint32_t bn=BLOCK_SIZE;
+    if ((tailX!=0) && (tailX-bx<bn)) {
+      bn=tailX-bx;
     }
-    
-    // balance volume modifier... this is independent
-    // of right/left enable. e.g. bal=1 with both enabled means signal entirely
-    // left and right will be zeroed. bal=0 means signal goes equally to both
-    // channels. This behavior is different from easy V1.
-    //
-    // Something to consider is this is non-linear but matches what a real
-    // balance potentiometer works.
-    
-    double bal=settings.bal->getValue(x);
-    double balR, balL;
-    if (bal>=0) {
-      balL=1.;
-      balR=1.-bal;
-    }
-    if (bal<0) {
-      balR=1.;
-      balL=(1.+bal);
-    }
-    if (balL>1) balL=1.;
-    if (balR>1) balR=1.;
-    
-    // update duty...
 
-    dutyThresh=dutyFD->getValue(x);
-    
-    // printf("phase: %d %f %d\n",x,phase,phaseX);
-    
-    // generate current value: note use of potentially
-    // shifted start pont for freq/sine calculation
+    amt->getBlock(countX,bn,amountB);         // amount can vary and is vol parameter
+    decay->getBlock(countX,bn,decayB);
+    size->getBlock(countX,bn,sizeB);
+    fdn.set(sizeB[0],decayB[0]);
 
-    //  SS   I   N   N  EEE                                       
-    // S     I   N N N  E     is done here 
-    //  S    I   N  NN  EE                                      
-    //   S   I   N   N  E                                      
-    // S S   I   N   N  EEE                                       
+    uint32_t dn=(bx<endX) ? endX-bx : 0;      // dry frames in this block
+    if (dn>bn) {
+      dn=bn;
+    }
+    if (dn>0) {
+      wavout->getBlock(bx,dn,inL,inR);
+    }
+    for (uint32_t i=dn;i<bn;i++) {
+      inL[i]=0;
+      inR[i]=0;
+    }
 
-    double radians=2*M_PI*freq*float((x-freqRefX)+phaseX)/SR;
-    double sineval=sin(radians);
+    fdn.process(inL,inR,outL,outR,bn);
 
-    //
-    // OTHER WAVEFORM TYPES...
-    //
-    
-    if (form==WF_SQUARE) {               // SQUARE
-      if ((countXadj)>dutyX) {  
-        sineval=0;
-      }
-      else if ((countXadj)>(dutyX/2)) {  
-        sineval=1;
-      }
-      else {
-        sineval=-1;
-      }
+    for (uint32_t i=0;i<bn;i++) {
+      outL[i]*=amountB[i];
+      outR[i]*=amountB[i];
     }
+    wavout->addBlock(bx,bn,outL,outR,chan);
+    countX+=bn;
+  }
+}
 
-    else if (form==WF_NOISE) {                // NOISE
-      noiseCounter++;
-      if (noiseCounter>noisePeriod) {   // noise will be influenced by freq
-        sineval=((float) rand()*2./(float) (RAND_MAX)-1);
-      }
-    }
-    
-    else if (form==WF_TRI) {            // TRI
-      int32_t adjCountX;
-      int32_t splitpt;
-      int32_t endpt;
-      
-      // TRI does not support duty cycle
-      
-      // map countX to adjCountX while keeping it within bounds 0 to periodX
-
-      adjCountX=countX+phaseX;  
-      if (adjCountX<0) {
-        adjCountX=adjCountX+periodX;
-      }
-      else if (adjCountX>(int) periodX) {
-        adjCountX=adjCountX-periodX;
-      }
-      
-      splitpt=periodX/2;
-      endpt=periodX;
+//----------------------------------------------------------------------
+// Filter runs the span through a biquad filter (see easy_filter.hpp)
+// and puts it back in place.
+//
+//   filter 20 lowpass 2000              cut above 2kHz
+//   filter 20 highpass 100 q 2 stages 2 cut below 100Hz, steeper
+//   filter 20 bandpass ramp 200 to 4000 20 q 4
+//
+// The cutoff and q are NumberDrivers read each block. left and right
+// apply, as usual.
 
-      if ((adjCountX>=0)&&(adjCountX<splitpt)) {
-        // oscval=1;
-        sineval=-1+trislope*adjCountX;
-      }
-      else if ((adjCountX>=splitpt)&&(adjCountX<=endpt)) {
-        // oscval=-1;
-        sineval=1-trislope*(adjCountX-splitpt);
-      }
-      else {
-        sineval=0;
-      }
+void doFilter (double length, int type, int stages, NumberDriver *cutoff, NumberDriver *q) {
+  uint32_t startX=wavout->findPosition(masterTime);
+  double endTime=masterTime+length;
+  uint32_t endX=wavout->findPosition(endTime);
+  int chan=(settings.left ? 1 : 0) | (settings.right ? 2 : 0);
 
-//      printf("countX %d adjphase %d oscval %f trislope %f splitpt %d endpt %d\n"
-//             ,countX,adjCountX,oscval,trislope,splitpt,endpt);
+  std::cout << MAG << "  Filter from " << masterTime << " to " << endTime << "\n" << WHT;
 
-    }
-    
-    else if (form==WF_SAW) {            // SAW
+  if (endX>wavout->maxPos) {  // limit our action to the current output range
+    endX=wavout->maxPos;
+  }
 
-      // SAW supports phase but not duty
-      // both negative and positive swing on SAW are needed
-      // for one full wavelength
+  cutoff->init(0);
+  q->init(0);
 
-      int32_t adjCountX;
-      
-      // map countX to adjCountX while keeping it within bounds 0 to periodX
+  Biquad filter(type,stages);
+  double cutoffB[BLOCK_SIZE];
+  double qB[BLOCK_SIZE];
+  float l[BLOCK_SIZE];
+  float r[BLOCK_SIZE];
+  uint32_t countX=0;
 
-      adjCountX=countX+phaseX;  
-      if (adjCountX<0) {
-        adjCountX=adjCountX+periodX;
-      }
-      else if (adjCountX>(int) periodX) {
-        adjCountX=adjCountX-periodX;
-      }
-      
-      sineval=-1+sawslope*adjCountX;
+  for (uint32_t bx=startX;bx<endX;bx+=BLOCK_SIZE) {
+    uint32_t bn=endX-bx;
+    if (bn>BLOCK_SIZE) {
+      bn=BLOCK_SIZE;
     }
+    cutoff->getBlock(countX,bn,cutoffB);
+    q->getBlock(countX,bn,qB);
+    filter.set(cutoffB[0],qB[0]);
+
+    wavout->getBlock(bx,bn,l,r);
+    filter.process(l,r,bn);
+    wavout->setBlock(bx,bn,l,r,chan);
+    countX+=bn;
+  }
+}
 
-    else if (form==WF_TENS) {            // TENS
+//----------------------------------------------------------------------
+// Circuit as an after-effect runs the circuit model (see
+// easy_filter.hpp) over what is already there, with the cirp and
+// ciri settings, the same as a sound made with circuit on.
+//
+//   circuit 20
 
-      // TENS has constant volume
-      // but instead makes wider pulses as volume
-      // increases. Actual volume does not change.
-      //
-      // duty has no effect.
-      // Phase has no effect (I seem to remember Easy V1 can do a sort of triphase TENS)
-      //
-      // Higher frequencies will deliver
-      // more power as the ratio of 0 time
-      // will be lower.
-      //
-      // rough calc:
-      // 500Hz is 2000us period
-      // aim for maybe 200us pulsewidth at 100% vol?
-      // so conversion factor around 1% = 1usec?
+void doCircuit (double length) {
+  uint32_t startX=wavout->findPosition(masterTime);
+  double endTime=masterTime+length;
+  uint32_t endX=wavout->findPosition(endTime);
+  int chan=(settings.left ? 1 : 0) | (settings.right ? 2 : 0);
 
-      // printf("tens: x %d width %d\n", x, tensX);
+  std::cout << MAG << "  Circuit from " << masterTime << " to " << endTime << "\n" << WHT;
 
-      tensX=int(.2*volnet*vol*SR/freq);   
+  if (endX>wavout->maxPos) {  // limit our action to the current output range
+    endX=wavout->maxPos;
+  }
 
-      if (countXadj<tensX) {
-        sineval=.95;
+  settings.cirp->init(0);
+  settings.ciri->init(0);
+  bool fixed=settings.cirp->isConstant() && settings.ciri->isConstant();
+  double cirp=settings.cirp->getValue(0);
+  double ciri=settings.ciri->getValue(0);
+
+  CircuitStage circuitL;
+  CircuitStage circuitR;
+  double cirpB[BLOCK_SIZE];
+  double ciriB[BLOCK_SIZE];
+  float l[BLOCK_SIZE];
+  float r[BLOCK_SIZE];
+  uint32_t countX=0;
+
+  for (uint32_t bx=startX;bx<endX;bx+=BLOCK_SIZE) {
+    uint32_t bn=endX-bx;
+    if (bn>BLOCK_SIZE) {
+      bn=BLOCK_SIZE;
+    }
+    if (!fixed) {
+      settings.cirp->getBlock(countX,bn,cirpB);
+      settings.ciri->getBlock(countX,bn,ciriB);
+      cirp=cirpB[0];
+      ciri=ciriB[0];
+    }
+
+    wavout->getBlock(bx,bn,l,r);
+    circuitL.run(l,bn,cirp,ciri,wavout->MAXVAL);
+    circuitR.run(r,bn,cirp,ciri,wavout->MAXVAL);
+    wavout->setBlock(bx,bn,l,r,chan);
+    countX+=bn;
+  }
+}
+
+//----------------------------------------------------------------------
+// true if any of the n values is non-zero. Used to skip work on
+// harmonics that are switched off.
+
+static bool anyNonZero(double *v, uint32_t n) {
+  for (uint32_t i=0;i<n;i++) {
+    if (v[i]!=0.) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//----------------------------------------------------------------------
+// SoundState holds everything the render kernels need for one
+// sound command: where it is going, the drivers, the running state
+// (accumulators, circuit, noise) and the block buffers.
+
+struct SoundState {
+  long startX;
+  long endX;
+  uint32_t mult;
+  int form;
+  bool blep;            // polyBLEP instead of the tables
+  int chan;             // 1 left, 2 right, 3 both, 0 neither
+  bool constv;          // vol, shape and bal are plain values
+  bool harm;            // the additive bank has partials
+
+  // MIX renders into a tile (see doMix) instead of the output.
+  // tileX0 is the x of tileL[0]; tileL is NULL for a plain sound.
+
+  float *tileL;
+  float *tileR;
+  uint32_t tileX0;
+
+  NumberDriver * freqFD;
+  NumberDriver * phaseFD;
+  NumberDriver * dutyFD;
+  NumberDriver * shapeFD;
+  NumberDriver * volFD;
+  NumberDriver * balFD;
+  NumberDriver * cirpFD;
+  NumberDriver * ciriFD;
+
+  PhaseAcc acc;         // carrier
+  CircuitStage circuit;
+  uint64_t noiseKey;
+
+  // coloured noise (see noiseBlock)
+
+  int32_t pinkRow[PINK_ROWS];
+  int64_t pinkSum;
+  uint32_t pinkNext;    // x the rows are ready for
+  double brownY;
+  double brownA;
+  double brownG;
+  Biquad band;
+  float bandB[BLOCK_SIZE];
+  float bandR[BLOCK_SIZE];  // the Biquad's other lane, unused
+
+  // cirp and ciri when they are plain values
+
+  bool circConst;
+  double cirp;
+  double ciri;
+
+  // the additive bank (see bankBlock). Each partial is played once
+  // per voice, with partial p of voice v on accumulator p*voices+v.
+  // The accumulators are kept as plain arrays, the same sums as
+  // PhaseAcc.
+
+  int partials;
+  Partial part[BANK_PARTIALS+2];
+  bool partFixed[BANK_PARTIALS+2];   // same freq all through the sound
+  double partF[BANK_PARTIALS+2];     // freq when it is a plain value
+  double partAmp[BANK_PARTIALS+2];   // vol when plain, else -1
+  uint64_t partOff[BANK_PARTIALS+2];
+  int voices;
+  double voice[BANK_VOICES];
+  uint64_t bankPhase[BANK_OSC];
+  uint64_t bankInc[BANK_OSC];
+  double bankFreq[BANK_OSC];
+
+  // the values going into the circuit are left here and it is run
+  // over them a block at a time (see circuitBlock). When a sound with
+  // the circuit on is split over threads the workers leave them in
+  // staged instead, one per sample, and circuitPass runs the circuit
+  // over that afterwards.
+
+  float circB[BLOCK_SIZE];
+  float *staged;
+
+  // fades are worked out from x alone, so no state is carried
+
+  long fadeinX;         // fade in length
+  double fadeinMul;     // 1/fadeinX
+  long fadeoutStartX;   // where fade out begins
+  double fadeoutMul;    // 1/fade out length
+
+  // vol, shape and bal when they are plain values
+
+  double vol;
+  double shapevol;
+  double balL;
+  double balR;
+
+  // NumberDrivers are pulled a block at a time into these
+
+  double freqB[BLOCK_SIZE];
+  double phaseB[BLOCK_SIZE];
+  double cycB[BLOCK_SIZE];
+  double hcycB[BLOCK_SIZE];
+  double hsineB[BLOCK_SIZE];
+  double bankB[BLOCK_SIZE];
+  double partFB[BLOCK_SIZE];
+  double partAB[BLOCK_SIZE];
+  double waveB[BLOCK_SIZE];
+  double shapeB[BLOCK_SIZE];
+  double volB[BLOCK_SIZE];
+  double balB[BLOCK_SIZE];
+  double dutyB[BLOCK_SIZE];
+  double noiseB[BLOCK_SIZE];
+  double cirpB[BLOCK_SIZE];
+  double ciriB[BLOCK_SIZE];
+};
+
+//----------------------------------------------------------------------
+// Does fadein-effect
+//
+// This is enabled by default as it is desirable for most signals.
+// x counts from the start of the sound.
+
+static inline double fadeIn(SoundState &s, uint32_t x) {
+  if ((long) x<s.fadeinX) {
+    return x*s.fadeinMul;
+  }
+  return 1.;
+}
+
+//--------------------------------------------------
+// Does fadeout effect.
+//
+// Not enabled by default. It can smooth any signal
+// discontinuities or finish off the end of
+// a signal in a more natural way.
+
+static inline double fadeOut(SoundState &s, uint32_t x) {
+  if ((long) x>s.fadeoutStartX) {
+    return 1-(x-s.fadeoutStartX)*s.fadeoutMul;
+  }
+  return 1.;
+}
+
+//----------------------------------------------------------------------
+// balance volume modifier... this is independent
+// of right/left enable. e.g. bal=1 with both enabled means signal entirely
+// left and right will be zeroed. bal=0 means signal goes equally to both
+// channels. This behavior is different from easy V1.
+//
+// Something to consider is this is non-linear but matches what a real
+// balance potentiometer works.
+
+static inline void balance(double bal, double &balL, double &balR) {
+  if (bal>=0) {
+    balL=1.;
+    balR=1.-bal;
+  }
+  else {
+    balR=1.;
+    balL=(1.+bal);
+  }
+  if (balL>1) balL=1.;
+  if (balR>1) balR=1.;
+}
+
+//----------------------------------------------------------------------
+// where a finished sample goes: the output, or the tile for MIX
+
+static inline void emit(SoundState &s, uint32_t x, float l, float r, int chan) {
+  if (s.tileL!=NULL) {
+    s.tileL[x-s.tileX0]=l;
+    s.tileR[x-s.tileX0]=r;
+  }
+  else {
+    wavout->setFrame(x+s.startX,l,r,chan);
+  }
+}
+
+//----------------------------------------------------------------------
+// runs the circuit over the n values in v for the block at bx and
+// writes them out. balB must already hold the block if bal varies.
+
+static void circuitBlock(SoundState &s, float *v, uint32_t bx, uint32_t bn, int chan, bool constv) {
+  double cirp=s.cirp;
+  double ciri=s.ciri;
+
+  if (!s.circConst) {                   // held for the block
+    s.cirpFD->getBlock(bx,bn,s.cirpB);
+    s.ciriFD->getBlock(bx,bn,s.ciriB);
+    cirp=s.cirpB[0];
+    ciri=s.ciriB[0];
+  }
+  s.circuit.run(v,bn,cirp,ciri,s.mult);
+
+  for (uint32_t i=0;i<bn;i++) {
+    double balL=s.balL;
+    double balR=s.balR;
+    if (!constv) {
+      balance(s.balB[i],balL,balR);
+    }
+    emit(s,bx+i,v[i]*balL,v[i]*balR,chan);
+  }
+}
+
+//----------------------------------------------------------------------
+// The coloured noises, a block at a time into waveB. All of them are
+// scaled to NOISE_RMS, which is where pink comes out, and kept within
+// -1..1.
+//
+// pink       Voss-McCartney: the sum of PINK_ROWS random rows, row k
+//            drawn again every 2^k samples. Each row's value is a
+//            function of x>>k, so only the rows that change are drawn
+//            (two on average) and the sum can be picked up from any x
+//            by drawing them all, which is how a worker thread starts.
+// brown      white noise through a leaky integrator, -6dB/octave down
+//            to BROWN_CORNER. It carries y from sample to sample.
+// bandnoise  white noise through a bandpass Biquad centred on freq,
+//            set once a block. The gain makes up for the width of the
+//            band, which lets through pi*f/(Q*SR) of the power.
+
+static inline int32_t pinkRow(uint64_t key, uint32_t x, int k) {
+  return (int32_t) (randBits(key,((uint64_t) (x>>k)<<5)|k)>>40)-(1<<23);
+}
+
+static void noiseBlock(SoundState &s, uint32_t bx, uint32_t bn) {
+  if (s.form==WF_PINK) {
+    const double scale=1./(PINK_ROWS*double(1<<23));
+
+    for (uint32_t i=0;i<bn;i++) {
+      uint32_t x=bx+i;
+      if (x!=s.pinkNext) {
+        s.pinkSum=0;
+        for (int k=0;k<PINK_ROWS;k++) {
+          s.pinkRow[k]=pinkRow(s.noiseKey,x,k);
+          s.pinkSum+=s.pinkRow[k];
+        }
       }
-      else if (countXadj<(tensX*2)) {
-        sineval=-.95;    // needs both polarities
+      else {
+        for (int k=0;(k<PINK_ROWS)&&((x&((1u<<k)-1))==0);k++) {
+          int32_t v=pinkRow(s.noiseKey,x,k);
+          s.pinkSum+=v-s.pinkRow[k];
+          s.pinkRow[k]=v;
+        }
+      }
+      s.pinkNext=x+1;
+      s.waveB[i]=s.pinkSum*scale;
+    }
+    return;
+  }
+
+  randBlock(s.noiseKey,bx,s.noiseB,bn);
+
+  if (s.form==WF_BROWN) {
+    double y=s.brownY;
+    for (uint32_t i=0;i<bn;i++) {
+      y=s.brownA*y+s.brownG*s.noiseB[i];
+      s.waveB[i]=y;
+    }
+    s.brownY=y;
+  }
+  else {                             // WF_BANDNOISE
+    double f=s.freqB[0];
+    if (f>.49*SR) {
+      f=.49*SR;
+    }
+    double gain=NOISE_RMS/(sqrt(1./3.)*sqrt(M_PI*f/(BAND_Q*SR)));
+
+    for (uint32_t i=0;i<bn;i++) {
+      s.bandB[i]=s.noiseB[i];
+      s.bandR[i]=0;
+    }
+    s.band.set(f,BAND_Q);
+    s.band.process(s.bandB,s.bandR,bn);
+    for (uint32_t i=0;i<bn;i++) {
+      s.waveB[i]=s.bandB[i]*gain;
+    }
+  }
+
+  for (uint32_t i=0;i<bn;i++) {
+    if (s.waveB[i]>1.) {
+      s.waveB[i]=1.;
+    }
+    if (s.waveB[i]<-1.) {
+      s.waveB[i]=-1.;
+    }
+  }
+}
+
+//----------------------------------------------------------------------
+// The additive bank, a block at a time into bankB.
+//
+// For each partial and voice the accumulator is run over the block
+// and the whole block of sines is done by the vector kernel, so the
+// per sample work is an add, a polynomial and a multiply-add. A
+// partial at a fixed frequency (a plain value, and the sound's freq
+// a plain value too if it is a multiple) skips the frequency
+// altogether. Partials whose vol is zero for the block only have
+// their phase moved on.
+//
+// freq2/vol2 and freq3/vol3 are the first two partials and give
+// exactly what they did when they had accumulators of their own.
+//
+// With render false only the phases are moved on, for bringing a
+// worker thread up to the start of its chunk (see seekBank).
+
+static inline void bankSetFreq(SoundState &s, int j, double f, double invRate) {
+  if (f!=s.bankFreq[j]) {
+    s.bankFreq[j]=f;
+    s.bankInc[j]=PhaseAcc::fromCycles(f*invRate);
+  }
+}
+
+static void bankLow(Partial &p, double f) {
+  printf("%sError - %s %fHz below low safety limit of %d\n%s",RED,p.name,f,LOW_FREQ_LIMIT,WHT);
+  exit(2);
+}
+
+static void bankBlock(SoundState &s, uint32_t bx, uint32_t bn, double invRate, bool render) {
+  if (render) {
+    for (uint32_t i=0;i<bn;i++) {
+      s.bankB[i]=0;
+    }
+  }
+
+  for (int p=0;p<s.partials;p++) {
+    Partial &pt=s.part[p];
+    double amp=s.partAmp[p];
+    bool fixed=s.partFixed[p];
+    bool varies=!pt.freq->isConstant();
+    bool active=render;
+
+    if (varies) {
+      pt.freq->getBlock(bx,bn,s.partFB);
+    }
+    if (render && (amp<0)) {
+      pt.amp->getBlock(bx,bn,s.partAB);
+      for (uint32_t i=0;i<bn;i++) {
+        s.partAB[i]=abs(s.partAB[i]);
+      }
+      active=anyNonZero(s.partAB,bn);
+    }
+
+    for (int v=0;v<s.voices;v++) {
+      int j=p*s.voices+v;
+      uint64_t phase=s.bankPhase[j];
+
+      if (fixed) {
+        double f=pt.hz ? abs(s.partF[p]) : abs(s.partF[p]*s.freqB[0]);
+        bankSetFreq(s,j,f*s.voice[v],invRate);
+
+        uint64_t inc=s.bankInc[j];
+        if (active) {
+          for (uint32_t i=0;i<bn;i++) {
+            s.hcycB[i]=PhaseAcc::toCycles(phase+s.partOff[p]);
+            phase+=inc;
+          }
+        }
+        else {
+          phase+=inc*bn;
+        }
+      }
+      else {
+        for (uint32_t i=0;i<bn;i++) {
+          double r=varies ? s.partFB[i] : s.partF[p];
+          double f=pt.hz ? abs(r) : abs(r*s.freqB[i]);
+          bankSetFreq(s,j,f*s.voice[v],invRate);
+          if (active) {
+            s.hcycB[i]=PhaseAcc::toCycles(phase+s.partOff[p]);
+            if ((s.bankFreq[j]<LOW_FREQ_LIMIT) && ((amp<0) ? s.partAB[i] : amp)>0) {
+              bankLow(pt,s.bankFreq[j]);
+            }
+          }
+          phase+=s.bankInc[j];
+        }
+      }
+      s.bankPhase[j]=phase;
+
+      if (!active) {
+        continue;
+      }
+      if (fixed && (s.bankFreq[j]<LOW_FREQ_LIMIT) &&
+          ((amp>0) || ((amp<0) && anyNonZero(s.partAB,bn)))) {
+        bankLow(pt,s.bankFreq[j]);
+      }
+
+      sineBlock(s.hcycB,s.hsineB,bn);
+      if (amp<0) {
+        for (uint32_t i=0;i<bn;i++) {
+          s.bankB[i]+=s.partAB[i]*s.hsineB[i];
+        }
       }
       else {
-        sineval=0;
+        for (uint32_t i=0;i<bn;i++) {
+          s.bankB[i]+=amp*s.hsineB[i];
+        }
       }
-      tensX++;
     }
-    
-    // update frequency... (for next iteration)
+  }
+}
+
+//----------------------------------------------------------------------
+// soundKernel renders one block of a sound.
+//
+// Everything that is fixed for the whole sound is a template
+// parameter so the tests drop out of the per-sample loop:
+//
+//  KFORM     waveform. TRI uses the SAW kernel, the table is picked at runtime,
+//            and the coloured noises the NOISE kernel
+//  KCIRCUIT  circuit model on
+//  KHARM     the additive bank has partials
+//  KCHAN     1 left, 2 right, 3 both
+//  KCONSTV   vol, shape and bal are plain values (read once in doSound)
+//  KRATE     44100 or 48000, or 0 to use SR at runtime
+//
+// (the K is there because easy_code.h already #defines FORM, CIRCUIT...)
+//
+// pickKernel below chooses the instance once per sound command.
+
+template<int KFORM, bool KCIRCUIT, bool KHARM, int KCHAN, bool KCONSTV, uint32_t KRATE>
+static void soundKernel(SoundState &s, uint32_t bx, uint32_t bn) {
+  const double rate=(KRATE!=0) ? KRATE : SR;
+  const double invRate=(KRATE!=0) ? 1./KRATE : 1./SR;
+  const int32_t mult=s.mult;
+
+  s.freqFD->getBlock(bx,bn,s.freqB);
+  s.phaseFD->getBlock(bx,bn,s.phaseB);
+  if (KFORM==WF_SQUARE) {
+    s.dutyFD->getBlock(bx,bn,s.dutyB);
+  }
+  if (!KCONSTV) {
+    s.shapeFD->getBlock(bx,bn,s.shapeB);
+    s.volFD->getBlock(bx,bn,s.volB);
+    s.balFD->getBlock(bx,bn,s.balB);
+  }
+  // run the phase accumulators over the whole block first
+  // so the sines can be done together by the vector kernel.
+  //
+  // frequency is picked up on every sample. The phase
+  // accumulator carries the wave across the change so
+  // there is no need to wait for a zero crossing.
+  //
+  // easyV1 had some hellish code to do phasors at various speeds
+  // and to limit adjustment speed. We're relying on phasors being
+  // driven by oscillators to hopefully make this unnecessary.
+
+  for (uint32_t i=0;i<bn;i++) {
+    s.acc.setFreq(s.freqB[i],invRate);
+    s.cycB[i]=s.acc.cycles(s.phaseB[i]);   // 0..1 through the cycle, phase applied
+    s.acc.step();
+  }
+
+  // the waveform for the block. SQUARE, TRI and SAW come from the
+  // band-limited tables, or polyBLEP if blep was asked for; TENS is
+  // still done per sample below. NOISE
+  // starts from the sine and switches over to the noise block below.
+  // The coloured noises replace the wave altogether.
+
+  if ((KFORM==WF_SQUARE)&&s.blep) {
+    blepBipolarBlock(s.cycB,s.freqB,s.dutyB,s.waveB,bn);
+  }
+  else if (KFORM==WF_SQUARE) {
+    tableBipolarBlock(s.cycB,s.freqB,s.dutyB,s.waveB,bn);
+  }
+  else if ((KFORM==WF_SAW)&&s.blep) {
+    blepBlock(s.form,s.cycB,s.freqB,s.waveB,bn);
+  }
+  else if (KFORM==WF_SAW) {
+    tableBlock(s.form,s.cycB,s.freqB,s.waveB,bn);
+  }
+  else if ((KFORM==WF_NOISE)&&(s.form!=WF_NOISE)) {
+    noiseBlock(s,bx,bn);
+  }
+  else if (KFORM!=WF_TENS) {
+    sineBlock(s.cycB,s.waveB,bn);
+  }
+  if ((KFORM==WF_NOISE)&&(s.form==WF_NOISE)) {
+    randBlock(s.noiseKey,bx,s.noiseB,bn);
+  }
+
+  // harmonics keep their own phase so they stay continuous
+  // when their freq is driven
+
+  if (KHARM) {
+    bankBlock(s,bx,bn,invRate,true);
+  }
+
+  for (uint32_t i=0;i<bn;i++) {
+    uint32_t x=bx+i;
+    double freq=s.freqB[i];
+
+    // effective volume...
+    //
+    // BUG here... phase should be affecting these as well
+    // but this is the phase of their numberDrivers,
+    // not the phase of the waveform (nested oscillators).
     //
-    // my experience with easy version 1 was that changing
-    // frequency mid-sound is very difficult. you have to
-    // wait for a negative zero crossing and only update
-    // frequency then.
+    // this is the problem:
+    // sound 10 phase .2 vol osc .5 to 1 freq 1p phase .5
     //
-    // what you can't do is recalcuate the frequency
-    // based on the same (reference) starting point as the original
-    // sine wave. Doing so would shift the entire wave thus far... but
-    // we've already written part of it... so the effect is bizzare
-    // and unexpected slews of frequency if you do it that way.
-    // To picture this: imagine a streched slinky passing
-    // over a fixed point along it's length. As each coil passes,
-    // you get a very different value. Instead, you need
-    // to move the starting point of the slinky plus the tension on it.
+    // the first phase .2 affects the sine wave itself
+    // the second phase .5 affects the volume modifier
     //
-    // Another way to do this would to only calculate the current sine-wave cycle,
-    // resetting the reference every time. But this is messy too.
+    // I think the answer is to handle it down in the NumberDriver. And I guess
+    // this could stack deeper, but the uses get harder to justify.
+
+    double shapevol=KCONSTV ? s.shapevol : s.shapeB[i];
+    double vol=KCONSTV ? s.vol : abs(s.volB[i]);
+    double volnet=fadeIn(s,x)*fadeOut(s,x)*shapevol;
+
+    if ((vol>0) && (freq<LOW_FREQ_LIMIT)) {
+      printf("%sError - freq %fHz below low safety limit of %d\n%s",RED,freq, LOW_FREQ_LIMIT,WHT);
+      exit(2);
+    }
+
+    double balL=s.balL;
+    double balR=s.balR;
+    if (!KCONSTV) {
+      balance(s.balB[i],balL,balR);
+    }
+
+    // generate current value: the block of waveform
+    // was already worked out above
 
-    if ((lastval<=0.0) && (sineval>0.0)) {      // detect end of sign wave cycle?
-      
-      lastfreq=freq;
-      freq=freqFD->getValue(x);  // use unmodified x reference
+    //  SS   I   N   N  EEE                                       
+    // S     I   N N N  E     is done here 
+    //  S    I   N  NN  EE                                      
+    //   S   I   N   N  E                                      
+    // S S   I   N   N  EEE                                       
 
-      updatePeriods();
+    double sineval=(KFORM==WF_TENS) ? 0 : s.waveB[i];
 
-      if (freq!=lastfreq) {                       // did frequency change?
-        // printf("new freq at %d %f -> %f \n",x, lastfreq,freq);
-        freqRefX=x-1;                             // new freq reference point for sine()
-        // note: this will cause a tiny audio artifact
-        // and if the frequency is ramped, this is going to be noticable
+    if ((KFORM==WF_NOISE)&&(s.form==WF_NOISE)) {   // NOISE
+      if (x+1>rate/freq) {              // noise will be influenced by freq
+        sineval=s.noiseB[i];
       }
     }
-    
-    lastval=sineval;
 
-    if (form==WF_TENS) {            // for TENS signal
-      if (settings.left) {
-        wavout->setValueL(x+startX,sineval*mult,scratch);
+    if (KFORM==WF_TENS) {            // TENS
+
+      // TENS has constant volume
+      // but instead makes wider pulses as volume
+      // increases. Actual volume does not change.
+      //
+      // duty has no effect.
+      // Phase has no effect (I seem to remember Easy V1 can do a sort of triphase TENS)
+      //
+      // Higher frequencies will deliver
+      // more power as the ratio of 0 time
+      // will be lower.
+      //
+      // rough calc:
+      // 500Hz is 2000us period
+      // aim for maybe 200us pulsewidth at 100% vol?
+      // so conversion factor around 1% = 1usec?
+      //
+      // pulse width here is in fractions of a cycle
+
+      double cyc=s.cycB[i];
+      double tensW=.2*volnet*vol;
+
+      if (cyc<tensW) {
+        sineval=.95;
       }
-      if (settings.right) {
-        wavout->setValueR(x+startX,sineval*mult,scratch);
+      else if (cyc<(tensW*2)) {
+        sineval=-.95;    // needs both polarities
       }
+
+      emit(s,x,sineval*mult,sineval*mult,KCHAN);
     }
     else {                                  // for other waveforms
 
       // harmonics are done here...
 
-      if (vol2>0.) {
-        sineval2=sin(2*M_PI*freq2*float(x)/SR);
-      }
-      else {
-        sineval2=0.;
-      }
-
-      if (vol3>0.) {
-        sineval3=sin(2*M_PI*freq3*float(x)/SR);
-      }
-      else {
-        sineval3=0.;
+      double harmval=0;
+      if (KHARM) {
+        harmval=s.bankB[i];
       }
 
-      int32_t waveval=volnet*mult*(vol*sineval+vol2*sineval2+vol3*sineval3);
-      int32_t outval=waveval;  // applies if Circuit effect not enabled
+      double waveval=volnet*mult*(vol*sineval+harmval);
+      double outval=waveval;  // applies if Circuit effect not enabled
 
       // circuit mimics the overshoot/undershoot in real circuitry
       // at full volume, this isn't useful but it creates more
@@ -726,9 +1246,17 @@ void doSound (double length, bool scratch) {
       //
       // circuit has little effect on sine waveforms until
       // a critical value his hit.
-
-      if (settings.circuit) {
-        outval=circuit.effect(x,waveval);
+      //
+      // It is run over the whole block below.
+
+      if (KCIRCUIT) {
+        if (s.staged!=NULL) {
+          s.staged[x]=waveval;
+        }
+        else {
+          s.circB[i]=waveval;
+        }
+        continue;
       }
 
       // write the current sample to output!
@@ -737,38 +1265,543 @@ void doSound (double length, bool scratch) {
       // O   O  U   U     T                 
       // O   O  U   U     T                 
       //  OOO    UUU      T                  
-    
-      if (settings.left) {
-        int32_t outvalL=outval*balL;     // applies if Circuit effect not enabled
-        wavout->setValueL(x+startX,outvalL,scratch);
-      }
-      if (settings.right) {
-        int32_t outvalR=outval*balR;     // applies if Circuit effect not enabled
-        wavout->setValueR(x+startX,outvalR,scratch);
+
+      emit(s,x,outval*balL,outval*balR,KCHAN);
+    }
+  }
+
+  if (KCIRCUIT && (s.staged==NULL)) {
+    circuitBlock(s,s.circB,bx,bn,KCHAN,KCONSTV);
+  }
+}
+
+//----------------------------------------------------------------------
+// Kernel selection. Each level fixes one more template parameter,
+// so all the instances are generated here and the choice is a few
+// branches per sound command.
+
+typedef void (*SoundKernel)(SoundState &s, uint32_t bx, uint32_t bn);
+
+template<int KFORM, bool KCIRCUIT, bool KHARM, int KCHAN, bool KCONSTV>
+static SoundKernel pickRate(void) {
+  if (SR==44100) {
+    return soundKernel<KFORM,KCIRCUIT,KHARM,KCHAN,KCONSTV,44100>;
+  }
+  if (SR==48000) {
+    return soundKernel<KFORM,KCIRCUIT,KHARM,KCHAN,KCONSTV,48000>;
+  }
+  return soundKernel<KFORM,KCIRCUIT,KHARM,KCHAN,KCONSTV,0>;
+}
+
+template<int KFORM, bool KCIRCUIT, bool KHARM, int KCHAN>
+static SoundKernel pickConst(bool constv) {
+  if (constv) {
+    return pickRate<KFORM,KCIRCUIT,KHARM,KCHAN,true>();
+  }
+  return pickRate<KFORM,KCIRCUIT,KHARM,KCHAN,false>();
+}
+
+template<int KFORM, bool KCIRCUIT, bool KHARM>
+static SoundKernel pickChan(int chan, bool constv) {
+  if (chan==1) {
+    return pickConst<KFORM,KCIRCUIT,KHARM,1>(constv);
+  }
+  if (chan==2) {
+    return pickConst<KFORM,KCIRCUIT,KHARM,2>(constv);
+  }
+  return pickConst<KFORM,KCIRCUIT,KHARM,3>(constv);
+}
+
+template<int KFORM>
+static SoundKernel pickMix(bool circuit, bool harm, int chan, bool constv) {
+  if (circuit) {
+    if (harm) {
+      return pickChan<KFORM,true,true>(chan,constv);
+    }
+    return pickChan<KFORM,true,false>(chan,constv);
+  }
+  if (harm) {
+    return pickChan<KFORM,false,true>(chan,constv);
+  }
+  return pickChan<KFORM,false,false>(chan,constv);
+}
+
+// TENS ignores harmonics and the circuit so it only varies on the rest
+
+static SoundKernel pickKernel(int form, bool circuit, bool harm, int chan, bool constv) {
+  if (form==WF_TENS) {
+    return pickChan<WF_TENS,false,false>(chan,constv);
+  }
+  if (form==WF_SQUARE) {
+    return pickMix<WF_SQUARE>(circuit,harm,chan,constv);
+  }
+  if ((form==WF_SAW)||(form==WF_TRI)) {
+    return pickMix<WF_SAW>(circuit,harm,chan,constv);
+  }
+  if (form>=WF_NOISE) {                // and the coloured noises
+    return pickMix<WF_NOISE>(circuit,harm,chan,constv);
+  }
+  return pickMix<WF_SINE>(circuit,harm,chan,constv);
+}
+
+//----------------------------------------------------------------------
+// Splitting one sound over threads (-j N)
+//
+// Each worker gets its own copy of the SoundState with clones of the
+// drivers, brings it to the start of its chunk and renders from there
+// into its own part of the output. Everything carried from sample to
+// sample has to be exactly what one thread would have had there:
+//
+//  drivers      seek()
+//  phase accs   sum of the increments so far (see seekAcc, seekBank)
+//  fades        already worked out from x alone
+//  circuit      each sample depends on the last through the clipping
+//               so it can't be started part way. The workers stop
+//               short of it and circuitPass runs it over the whole
+//               sound afterwards, which is cheap next to the rest.
+//  noise        a function of x (see easy_rand.hpp), pink too. brown
+//               and bandnoise carry state so aren't split.
+
+#define MIN_CHUNK_X 65536       // not worth a thread below this
+
+struct SoundChunk {
+  SoundState *s;
+  SoundKernel kernel;
+  bool harm;
+  uint32_t x0;                  // first sample
+  uint32_t x1;                  // one past the last
+};
+
+//----------------------------------------------------------------------
+// set acc to where it would be after samples 0..x-1, done the same
+// way as the kernel (integer sums, so the result is exact). fd is
+// left at x.
+
+static void seekAcc(PhaseAcc &acc, NumberDriver *fd, uint32_t x, bool harmonic) {
+  double invRate=1./SR;
+
+  if (fd->isConstant()) {
+    double f=fd->getValue(0);
+    if (harmonic) {
+      f=abs(f);
+    }
+    acc.setFreq(f,invRate);
+    acc.phase=acc.inc*x;
+    fd->seek(x);
+    return;
+  }
+
+  double freqB[BLOCK_SIZE];
+
+  fd->seek(0);
+  for (uint32_t bx=0;bx<x;bx+=BLOCK_SIZE) {
+    uint32_t bn=(x-bx>BLOCK_SIZE) ? BLOCK_SIZE : x-bx;
+    fd->getBlock(bx,bn,freqB);
+    for (uint32_t i=0;i<bn;i++) {
+      double f=harmonic ? abs(freqB[i]) : freqB[i];
+      acc.setFreq(f,invRate);
+      acc.step();
+    }
+  }
+}
+
+//----------------------------------------------------------------------
+// the same for the bank's accumulators. The carrier's freq driver is
+// walked again if a partial follows it, and is left at x either way.
+
+static void seekBank(SoundState &s, uint32_t x) {
+  double invRate=1./SR;
+  bool fixed=true;
+
+  for (int p=0;p<s.partials;p++) {
+    s.part[p].amp->seek(x);
+    fixed=fixed && s.partFixed[p];
+  }
+
+  if (fixed) {
+    for (int p=0;p<s.partials;p++) {
+      double f=s.part[p].hz ? abs(s.partF[p]) : abs(s.partF[p]*s.freqFD->getValue(0));
+      for (int v=0;v<s.voices;v++) {
+        int j=p*s.voices+v;
+        bankSetFreq(s,j,f*s.voice[v],invRate);
+        s.bankPhase[j]=s.bankInc[j]*x;
       }
-    
-      // std::cout << "x:" << x << " value: " << waveval << " f1:" << fadein << " f2:" << fadeout << " vol:" << settings.vol->getValue(x) << "\n";
     }
+    return;
+  }
+
+  s.freqFD->seek(0);
+  for (int p=0;p<s.partials;p++) {
+    s.part[p].freq->seek(0);
+  }
+  for (uint32_t bx=0;bx<x;bx+=BLOCK_SIZE) {
+    uint32_t bn=(x-bx>BLOCK_SIZE) ? BLOCK_SIZE : x-bx;
+    s.freqFD->getBlock(bx,bn,s.freqB);
+    bankBlock(s,bx,bn,invRate,false);
+  }
+}
+
+//----------------------------------------------------------------------
+// worker thread
 
+static void renderChunk(SoundChunk *c) {
+  SoundState &s=*c->s;
+
+  s.phaseFD->seek(c->x0);
+  s.dutyFD->seek(c->x0);
+  s.shapeFD->seek(c->x0);
+  s.volFD->seek(c->x0);
+  s.balFD->seek(c->x0);
+
+  seekAcc(s.acc,s.freqFD,c->x0,false);
+  if (c->harm) {
+    seekBank(s,c->x0);
   }
 
-  if (endX>wavout->maxPos) {
+  for (uint32_t bx=c->x0;bx<c->x1;bx+=BLOCK_SIZE) {
+    uint32_t bn=c->x1-bx;
+    if (bn>BLOCK_SIZE) {
+      bn=BLOCK_SIZE;
+    }
+    c->kernel(s,bx,bn);
+  }
+}
+
+//----------------------------------------------------------------------
+// runs the circuit over the values the workers staged, in order,
+// and writes them out, the same as soundKernel would have.
+
+static void circuitPass(SoundState &s, uint32_t deltaX, int chan, bool constv) {
+  for (uint32_t bx=0;bx<deltaX;bx+=BLOCK_SIZE) {
+    uint32_t bn=deltaX-bx;
+    if (bn>BLOCK_SIZE) {
+      bn=BLOCK_SIZE;
+    }
+    if (!constv) {
+      s.balFD->getBlock(bx,bn,s.balB);
+    }
+    circuitBlock(s,s.staged+bx,bx,bn,chan,constv);
+  }
+}
+
+//----------------------------------------------------------------------
+// how many pieces to cut a sound into: 1 means render it in line
+
+static int soundChunks(SoundState *s, uint32_t deltaX, bool harm) {
+  if ((flagJobs<2) || (deltaX<2*MIN_CHUNK_X)) {
+    return 1;
+  }
+  if ((s->form==WF_BROWN) || (s->form==WF_BANDNOISE)) {
+    return 1;
+  }
+
+  std::vector<NumberDriver *> used;
+
+  used.push_back(s->freqFD);
+  used.push_back(s->phaseFD);
+  used.push_back(s->dutyFD);
+  used.push_back(s->shapeFD);
+  used.push_back(s->volFD);
+  used.push_back(s->balFD);
+  if (harm) {
+    for (int p=0;p<s->partials;p++) {
+      used.push_back(s->part[p].freq);
+      used.push_back(s->part[p].amp);
+    }
+  }
+  if (settings.circuit && (s->form!=WF_TENS)) {
+    used.push_back(s->cirpFD);
+    used.push_back(s->ciriFD);
+  }
+
+  // no driver may be shared
+
+  std::vector<NumberDriver *> state;
+  for (NumberDriver *nd : used) {
+    nd->addState(state);
+  }
+  std::sort(state.begin(),state.end());
+  if (std::adjacent_find(state.begin(),state.end())!=state.end()) {
+    return 1;
+  }
+
+  uint32_t most=deltaX/MIN_CHUNK_X;
+  if ((uint32_t) flagJobs<most) {
+    return flagJobs;
+  }
+  return most;
+}
+
+//----------------------------------------------------------------------
+// render deltaX samples of s in chunks, one thread per chunk
+
+static void renderThreaded(SoundState *s, SoundKernel kernel, int chunks,
+                           uint32_t deltaX, int chan, bool constv, bool harm) {
+  bool circuit=settings.circuit && (s->form!=WF_TENS);
+
+  // anything the workers would otherwise set up or grow on first
+  // use is done here, before they start
+
+  waveTable(WF_SAW);
+  waveTable(WF_TRI);
+
+  wavout->checkSize(s->endX-1);
+
+  if (circuit) {
+    s->staged=new float[deltaX];
+  }
+
+  // chunks start on a block boundary. Rounding up can leave nothing
+  // for the last few, so there may be fewer chunks than asked for,
+  // and none of them reaches past deltaX.
+
+  uint32_t chunkX=(deltaX/chunks+BLOCK_SIZE-1)/BLOCK_SIZE*BLOCK_SIZE;
+  chunks=(deltaX+chunkX-1)/chunkX;
+
+  printf("%s    rendering on %d threads\n%s",MAG,chunks,WHT);
+
+  std::vector<SoundState *> states;
+  std::vector<SoundChunk> jobs(chunks);
+  std::vector<std::thread> threads;
+
+  for (int k=0;k<chunks;k++) {
+    SoundState *c=new SoundState(*s);
+
+    c->freqFD=s->freqFD->clone();
+    c->phaseFD=s->phaseFD->clone();
+    c->dutyFD=s->dutyFD->clone();
+    c->shapeFD=s->shapeFD->clone();
+    c->volFD=s->volFD->clone();
+    c->balFD=s->balFD->clone();
+    for (int p=0;p<s->partials;p++) {
+      c->part[p].freq=s->part[p].freq->clone();
+      c->part[p].amp=s->part[p].amp->clone();
+    }
+    states.push_back(c);
+
+    jobs[k].s=c;
+    jobs[k].kernel=kernel;
+    jobs[k].harm=harm;
+    jobs[k].x0=k*chunkX;
+    jobs[k].x1=(k==chunks-1) ? deltaX : (k+1)*chunkX;
+  }
+
+  for (int k=0;k<chunks;k++) {
+    threads.push_back(std::thread(renderChunk,&jobs[k]));
+  }
+  for (int k=0;k<chunks;k++) {
+    threads[k].join();
+  }
+
+  for (SoundState *c : states) {
+    delete c->freqFD;
+    delete c->phaseFD;
+    delete c->dutyFD;
+    delete c->shapeFD;
+    delete c->volFD;
+    delete c->balFD;
+    for (int p=0;p<c->partials;p++) {
+      delete c->part[p].freq;
+      delete c->part[p].amp;
+    }
+    delete c;
+  }
+
+  if (circuit) {
+    circuitPass(*s,deltaX,chan,constv);
+    delete[] s->staged;
+    s->staged=NULL;
+  }
+}
+
+//======================================================================
+// doSound
+//
+// Most of the sound generation is done here including
+// all the waveform types. From experience, I know that this code
+// can get VERY messy quickly.
+//
+// Some tips:
+// - variables ending in X pertain to sample locations/times in integer format
+// - be mindful of whether a sample value is in double (-1 to 1) or integer
+//   format (e.g. -32768 to -32767).
+// - coding style should be expansive (step by step) rather than condensed
+//   to facilitate debugging. (Let compiler optimizations handle speed.)
+//
+// The per-sample work is in soundKernel above. soundSetup gets a
+// SoundState ready from the settings (MIX starts the same way) and
+// doSound picks the kernel and feeds it blocks.
+
+static void addPartial(SoundState *s, Partial &p) {
+  p.freq->init(0);
+  p.amp->init(0);
+  if (p.amp->isConstant() && (p.amp->getValue(0)==0)) {
+    return;
+  }
+
+  int k=s->partials++;
+  s->part[k]=p;
+  s->partF[k]=p.freq->isConstant() ? p.freq->getValue(0) : 0;
+  s->partFixed[k]=p.freq->isConstant() && (p.hz || s->freqFD->isConstant());
+  s->partAmp[k]=p.amp->isConstant() ? abs(p.amp->getValue(0)) : -1;
+  s->partOff[k]=PhaseAcc::fromCycles(p.offset);
+}
+
+static SoundState * soundSetup(double length) {
+  double endTime=masterTime+length;
+  SoundState * s=new SoundState;   // too big for the stack
+
+  std::cout << MAG << "  Sound from " << masterTime << " to " << endTime << "\n" << WHT;
+
+  // what if no output command was ever given?
+  // initialize output buffers to default
+
+  if (wavout==NULL) {
+      wavout=new WaveWriter(defaultFormat*60*10,defaultFormat);
+  }
+  
+  // std::cout << "Play a sound from " << masterTime << " to " << endTime << "\n";
+
+  s->startX=wavout->findPosition(masterTime);
+  s->endX=wavout->findPosition(endTime);
+  s->mult=wavout->MAXVAL;
+  s->tileL=NULL;
+  s->tileR=NULL;
+  s->tileX0=0;
+  soundLengthX=length*SR;     // needed for shape and ramp which can repeat
+
+  // initialize shape if it is being used and not already set
+
+  settings.shape->init(soundLengthX);
+  
+  // setup work...
+  // NumberDrivers to strange stuff when you don't init them
+  
+  s->freqFD=settings.freqStack.top();
+  s->phaseFD=settings.phaseStack.top();
+  s->form=settings.formStack.top();
+  s->blep=(s->form&WF_BLEP)!=0;
+  s->form&=~WF_BLEP;
+  s->dutyFD=settings.dutyStack.top();  
+  s->shapeFD=settings.shape;
+  s->volFD=settings.vol;
+  s->balFD=settings.bal;
+  s->cirpFD=settings.cirp;
+  s->ciriFD=settings.ciri;
+  s->staged=NULL;
+
+  // initialize shape if it is being used and not already set
+
+  s->dutyFD->init(soundLengthX);  // needs initializing, I guess
+  
+  s->freqFD->init(0);                  
+  s->phaseFD->init(0);                  
+  settings.bal->init(0);
+  settings.vol->init(0);
+    
+  s->circuit.zero();                        // clear any history in Circuit model
+  s->circConst=settings.cirp->isConstant() && settings.ciri->isConstant();
+  if (s->circConst) {
+    s->cirp=settings.cirp->getValue(0);
+    s->ciri=settings.ciri->getValue(0);
+  }
+  s->noiseKey=noiseKey;
+  s->pinkNext=UINT32_MAX;                   // draw all the rows first time
+  s->brownY=0;
+  s->brownA=exp(-2.*M_PI*BROWN_CORNER/SR);
+  s->brownG=NOISE_RMS*sqrt(3.*(1.-s->brownA*s->brownA));
+  s->band=Biquad(BANDPASS,1);
+
+  // generation work...
+
+  uint32_t deltaX=s->endX-s->startX;
+
+  // fades
+
+  s->fadeinX=settings.fadein*SR;          // convert sec to frames
+  s->fadeinMul=(s->fadeinX>0) ? 1./s->fadeinX : 0;
+  long spanFade=settings.fadeout*SR;
+  s->fadeoutStartX=deltaX-spanFade;
+  s->fadeoutMul=(spanFade>0) ? 1./spanFade : 0;
+
+  // plain values only need reading once
+
+  s->constv=settings.vol->isConstant() && settings.shape->isConstant() && settings.bal->isConstant();
+  if (s->constv) {
+    s->vol=abs(settings.vol->getValue(0));
+    s->shapevol=settings.shape->getValue(0);
+    balance(settings.bal->getValue(0),s->balL,s->balR);
+  }
+
+  // the additive bank. Partials fixed at zero are left out, and
+  // without any the bank is left out altogether.
+
+  Partial h2={settings.freq2,settings.vol2,true,0,"freq2"};
+  Partial h3={settings.freq3,settings.vol3,true,0,"freq3"};
+
+  s->partials=0;
+  addPartial(s,h2);
+  addPartial(s,h3);
+  for (Partial &p : settings.partials) {
+    addPartial(s,p);
+  }
+  s->voices=settings.chord.empty() ? 1 : settings.chord.size();
+  for (int v=0;v<s->voices;v++) {
+    s->voice[v]=settings.chord.empty() ? 1. : settings.chord[v];
+  }
+  for (int j=0;j<BANK_OSC;j++) {
+    s->bankPhase[j]=0;
+    s->bankInc[j]=0;
+    s->bankFreq[j]=0;
+  }
+  s->harm=(s->partials>0);
+
+  s->chan=(settings.left ? 1 : 0) | (settings.right ? 2 : 0);
+  return s;
+}
+
+void doSound (double length) {
+  SoundState * s=soundSetup(length);
+  uint32_t deltaX=s->endX-s->startX;
+
+  if (s->chan!=0) {               // nothing to write if both are off
+    SoundKernel kernel=pickKernel(s->form,settings.circuit,s->harm,s->chan,s->constv);
+    int chunks=soundChunks(s,deltaX,s->harm);
+
+    if (chunks>1) {
+      renderThreaded(s,kernel,chunks,deltaX,s->chan,s->constv,s->harm);
+    }
+    else {
+      for (uint32_t bx=0;bx<deltaX;bx+=BLOCK_SIZE) {
+        uint32_t bn=deltaX-bx;
+        if (bn>BLOCK_SIZE) {
+          bn=BLOCK_SIZE;
+        }
+        kernel(*s,bx,bn);
+      }
+    }
+  }
+
+  if (s->endX>wavout->maxPos) {
     // printf("maxX: %d\n",wavout->maxPos);
-    wavout->maxPos=endX;
+    wavout->maxPos=s->endX;
   }
 
+  delete s;
+
   // take a look at our output for DEBUG
   
   // wavout->DEBUG(0,100);
 
 }
 
+
 //----------------------------------------------------------------------
 // doMix
 //
-// Mix requires several stages. First, the sound is written to
-// the scratch space. Next, the audio levels of both the new sound
-// and the existing sound are assessed.
+// Mix requires several stages. First, the audio levels of both the
+// new sound and the existing sound are assessed. Then the new sound
+// is blended into the existing one.
 //
 // The volume of each sound is adjusted according to the automix
 // maximum and the proportion of the signals.
@@ -804,93 +1837,176 @@ void doSound (double length, bool scratch) {
 //
 //            multfactor=exist/(vol+exist)
 //
+// The new sound used to be written out in full to a second pair of
+// output-sized scratch buffers and then read back twice. Now it is
+// rendered a tile of MIX_TILE frames at a time, small enough to stay
+// in cache between being made and being mixed in:
+//
+//  pass 1   a twin of the SoundState, with its own clones of the
+//           drivers, renders every tile to find the new peak
+//  pass 2   the original renders the same tiles again and each is
+//           blended into the output straight away
+//
+// Every driver and the noise give the same samples the second time
+// (see easy_rand.hpp for NOISE and randseq).
+
+#define MIX_TILE 4096           // frames, a multiple of BLOCK_SIZE
+
+//----------------------------------------------------------------------
+// render frames x0..x0+n-1 of the sound into tileL/tileR
+
+static void renderTile(SoundState *s, SoundKernel kernel, uint32_t x0, uint32_t n,
+                       float *tileL, float *tileR) {
+  s->tileL=tileL;
+  s->tileR=tileR;
+  s->tileX0=x0;
+
+  for (uint32_t bx=x0;bx<x0+n;bx+=BLOCK_SIZE) {
+    uint32_t bn=x0+n-bx;
+    if (bn>BLOCK_SIZE) {
+      bn=BLOCK_SIZE;
+    }
+    kernel(*s,bx,bn);
+  }
+}
+
+static float tilePeak(float *tileL, float *tileR, uint32_t n, int chan, float max) {
+  for (uint32_t i=0;i<n;i++) {
+    if ((chan&1) && (fabsf(tileL[i])>max)) {
+      max=fabsf(tileL[i]);
+    }
+    if ((chan&2) && (fabsf(tileR[i])>max)) {
+      max=fabsf(tileR[i]);
+    }
+  }
+  return max;
+}
+
+//----------------------------------------------------------------------
+// find the peak of the new sound on a twin of s. The drivers are
+// cloned as one group so any shared between them stay shared.
+
+static float mixPeak(SoundState *s, SoundKernel kernel, uint32_t deltaX,
+                     float *tileL, float *tileR) {
+  SoundState *t=new SoundState(*s);
+  std::map<NumberDriver *,NumberDriver *> memo;
+  float max=0;
+
+  cloneMemo=&memo;
+  t->freqFD=cloneDriver(s->freqFD);
+  t->phaseFD=cloneDriver(s->phaseFD);
+  t->dutyFD=cloneDriver(s->dutyFD);
+  t->shapeFD=cloneDriver(s->shapeFD);
+  t->volFD=cloneDriver(s->volFD);
+  t->balFD=cloneDriver(s->balFD);
+  for (int p=0;p<s->partials;p++) {
+    t->part[p].freq=cloneDriver(s->part[p].freq);
+    t->part[p].amp=cloneDriver(s->part[p].amp);
+  }
+  if (settings.circuit) {
+    t->cirpFD=cloneDriver(s->cirpFD);
+    t->ciriFD=cloneDriver(s->ciriFD);
+  }
+  cloneMemo=NULL;
+
+  for (uint32_t x0=0;x0<deltaX;x0+=MIX_TILE) {
+    uint32_t n=(deltaX-x0>MIX_TILE) ? MIX_TILE : deltaX-x0;
+    renderTile(t,kernel,x0,n,tileL,tileR);
+    max=tilePeak(tileL,tileR,n,s->chan,max);
+  }
+
+  for (std::map<NumberDriver *,NumberDriver *>::iterator it=memo.begin();it!=memo.end();it++) {
+    delete it->second;
+  }
+  delete t;
+  return max;
+}
+
+//----------------------------------------------------------------------
+
 void doMix(double length) {
-  int32_t mult=wavout->MAXVAL;
-  int32_t beforemax=0;
-  int32_t newmax=0;
-  int32_t value=0;
+  SoundState *s=soundSetup(length);
+  int32_t mult=s->mult;
+  float beforemax=0;
+  float newmax=0;
   double newmaxPct;
   double beforemaxPct;
-  uint32_t startX=masterTime*SR;
-  double endTime=masterTime+length;
-  uint32_t endX=endTime*SR;
+  uint32_t startX=s->startX;
+  uint32_t endX=s->endX;
+  uint32_t deltaX=endX-startX;
   double AM=settings.automix;
+  int chan=s->chan;
 
   printf("%s  Mix exammining %d to %d   ... %d\n%s",MAG,startX,endX,mult,WHT);
 
-  // first, sample the current audio
+  if (chan!=0) {                  // nothing to mix if both are off
+    SoundKernel kernel=pickKernel(s->form,settings.circuit,s->harm,chan,s->constv);
+    float *tileL=new float[MIX_TILE];
+    float *tileR=new float[MIX_TILE];
 
-  for (uint32_t x=startX; x<endX; x++) {
-    if (settings.left) {
-      value=wavout->getValueL(x, false);
-      if (abs(value)>beforemax) {
-        beforemax=abs(value);
-        // printf("  L beforemax: %d %d\n",x,beforemax);
-      }
-    }
-    if (settings.right) {
-      value=wavout->getValueR(x,false);
-      if (abs(value)>beforemax) {
-        beforemax=abs(value);
-        //       printf("  R beforemax: %d %d\n",x,beforemax);
-      }
-    }
-  }
+    // first, sample the current audio
 
-  beforemaxPct=beforemax/double(mult);
-  
-  //  next, sample the new audio
-  
-  for (uint32_t x=startX; x<endX; x++) {
-    if (settings.left) {
-      value=wavout->getValueL(x, true);
-      if (abs(value)>newmax) {
-        newmax=abs(value);
-//        printf("  L newmax: %d %d\n",x,newmax);
-      }
-    }
-    if (settings.right) {
-      value=wavout->getValueR(x,true);
-      if (abs(value)>newmax) {
-        newmax=abs(value);
-//        printf("  R newmax: %d %d\n",x,newmax);
-      }
-    }
-  }
-  
-  newmaxPct=newmax/double(mult);
+    beforemax=wavout->peak(startX,endX,chan);
+    beforemaxPct=beforemax/double(mult);
 
-//  printf("  beforemax: %f  newmax: %f\n",beforemaxPct,newmaxPct);
+    //  next, sample the new audio
 
-  // so working out the 2 new ratios for mixing...
-  
-  double mixNew=AM*newmaxPct/(newmaxPct+beforemaxPct);
-  double mixBefore=beforemaxPct/(newmaxPct+beforemaxPct);
+    newmax=mixPeak(s,kernel,deltaX,tileL,tileR);
+    newmaxPct=newmax/double(mult);
 
-  printf("%s  new/old mix ratio: %f %f\n%s",MAG,mixNew,mixBefore,WHT);
+    //  printf("  beforemax: %f  newmax: %f\n",beforemaxPct,newmaxPct);
 
-  // do the mix, finally!
+    // so working out the 2 new ratios for mixing... if both are
+    // silent there is nothing to scale and the result is silence
 
-  for (uint32_t x=startX; x<endX; x++) {
-    double value1;
-    double value2;
-    double value3;
-    if (settings.left) {
-      value1=mixNew*wavout->getValueL(x, true)/mult;
-      value2=mixBefore*wavout->getValueL(x, false)/mult;
-      value3=value1+value2;
-      int32_t waveval=value3*mult;
-      wavout->setValueL(x,waveval,false);
+    double mixNew=0;
+    double mixBefore=0;
+    if (newmaxPct+beforemaxPct>0) {
+      mixNew=AM*newmaxPct/(newmaxPct+beforemaxPct);
+      mixBefore=beforemaxPct/(newmaxPct+beforemaxPct);
     }
-    if (settings.right) {
-      value1=mixNew*wavout->getValueR(x, true)/mult;
-      value2=mixBefore*wavout->getValueR(x, false)/mult;
-      value3=value1+value2;
-      int32_t waveval=value3*mult;
-      wavout->setValueR(x,waveval,false);
+
+    printf("%s  new/old mix ratio: %f %f\n%s",MAG,mixNew,mixBefore,WHT);
+
+    // do the mix, finally!
+
+    for (uint32_t x0=0;x0<deltaX;x0+=MIX_TILE) {
+      uint32_t n=(deltaX-x0>MIX_TILE) ? MIX_TILE : deltaX-x0;
+
+      renderTile(s,kernel,x0,n,tileL,tileR);
+
+      for (uint32_t i=0;i<n;i++) {
+        uint32_t x=startX+x0+i;
+        double value1;
+        double value2;
+        double value3;
+        float l;
+        float r;
+
+        wavout->getFrame(x,l,r);
+        if (chan&1) {
+          value1=mixNew*tileL[i]/mult;
+          value2=mixBefore*l/mult;
+          value3=value1+value2;
+          l=value3*mult;
+        }
+        if (chan&2) {
+          value1=mixNew*tileR[i]/mult;
+          value2=mixBefore*r/mult;
+          value3=value1+value2;
+          r=value3*mult;
+        }
+        wavout->setFrame(x,l,r,chan);
+      }
     }
-  }
-}
 
+    delete[] tileL;
+    delete[] tileR;
+  }
 
+  if (s->endX>wavout->maxPos) {
+    wavout->maxPos=s->endX;
+  }
 
+  delete s;
+}
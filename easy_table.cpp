@@ -0,0 +1,208 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// table
+//
+// Builds and reads the band-limited wavetables described in
+// easy_table.hpp.
+//
+// The harmonic series used:
+//
+//   SAW (-1 rising to +1)   -2/pi * sum    sin(2 pi k p)/k     all k
+//   TRI (-1 at p=0)         -8/pi^2 * sum  cos(2 pi k p)/k^2   odd k
+//
+// Cutting a series off hard makes the top harmonic ring (Gibbs) and
+// the saw overshoots by about 9%. Each harmonic is scaled by the
+// Lanczos sigma factor which brings that down to around 1%, and the
+// table is then clipped at +/-1 so no new waveform is louder than the
+// old one was.
+//
+//----------------------------------------------------------------------
+
+extern "C" {
+  #include "easy_code.h"
+}
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "easy_table.hpp"
+
+extern uint32_t SR;
+
+static WaveTable sawTable(WF_SAW);
+static WaveTable triTable(WF_TRI);
+
+static double sinTable[TABLE_SIZE];    // one cycle of sine for building
+static bool sinTableDone=false;
+
+//----------------------------------------------------------------------
+// clip to the -1..+1 range of the original waveforms
+
+static inline double clip1(double v) {
+  if (v>1.) {
+    return 1.;
+  }
+  if (v<-1.) {
+    return -1.;
+  }
+  return v;
+}
+
+//----------------------------------------------------------------------
+// build all octaves for sample rate sr
+
+void WaveTable::build(uint32_t sr) {
+  if (!sinTableDone) {
+    for (int i=0;i<TABLE_SIZE;i++) {
+      sinTable[i]=sin(2.*M_PI*i/TABLE_SIZE);
+    }
+    sinTableDone=true;
+  }
+
+  for (int lvl=0;lvl<TABLE_LEVELS;lvl++) {
+    double topFreq=TABLE_BASE_FREQ*pow(2.,lvl+1);
+    int harmonics=int(sr/2./topFreq);
+
+    if (harmonics<1) {
+      harmonics=1;             // always keep the fundamental
+    }
+    if (harmonics>TABLE_SIZE/2-1) {
+      harmonics=TABLE_SIZE/2-1;
+    }
+
+    double *t=table[lvl];
+    for (int i=0;i<TABLE_SIZE;i++) {
+      t[i]=0.;
+    }
+
+    for (int k=1;k<=harmonics;k++) {
+      double amp;
+      int offset;                 // TABLE_SIZE/4 turns sin into cos
+
+      if (form==WF_SAW) {
+        amp=-2./(M_PI*k);
+        offset=0;
+      }
+      else {                      // WF_TRI
+        if ((k%2)==0) {
+          continue;
+        }
+        amp=-8./(M_PI*M_PI*k*k);
+        offset=TABLE_SIZE/4;
+      }
+
+      // Lanczos sigma factor
+
+      double sx=M_PI*k/(harmonics+1);
+      amp=amp*sin(sx)/sx;
+
+      // k*i is exact so the index wraps without any rounding
+
+      for (int i=0;i<TABLE_SIZE;i++) {
+        t[i]+=amp*sinTable[(k*i+offset)&(TABLE_SIZE-1)];
+      }
+    }
+
+    for (int i=0;i<TABLE_SIZE;i++) {
+      t[i]=clip1(t[i]);
+    }
+    t[TABLE_SIZE]=t[0];
+  }
+  builtSR=sr;
+}
+
+//----------------------------------------------------------------------
+
+WaveTable * waveTable(int form) {
+  WaveTable *t;
+
+  if (form==WF_SAW) {
+    t=&sawTable;
+  }
+  else if (form==WF_TRI) {
+    t=&triTable;
+  }
+  else {
+    printf("%sError - no wavetable for form %d\n%s",RED,form,WHT);
+    exit(2);
+  }
+
+  if (t->builtSR!=SR) {
+    t->build(SR);
+  }
+  return t;
+}
+
+//----------------------------------------------------------------------
+// pulses from saws: s(p)-s(p-d) steps down at 0 and up at d. Adding
+// the right offset gives a pulse with no DC error, and because both
+// saws are band-limited so is the pulse.
+
+static inline double pulseAt(WaveTable *saw, double cyc, int lvl, double duty) {
+  return clip1((2.*duty-1.)-(saw->read(cyc,lvl)-saw->read(cyc-duty,lvl)));
+}
+
+// SOUND's square: -1 for the first half of duty, +1 for the second,
+// 0 after that. Works out to the sum of three saws.
+
+static inline double bipolarAt(WaveTable *saw, double cyc, int lvl, double duty) {
+  return clip1(.5*saw->read(cyc,lvl)+.5*saw->read(cyc-duty,lvl)-saw->read(cyc-duty/2.,lvl));
+}
+
+double tableSaw(double cyc, double freq) {
+  return waveTable(WF_SAW)->read(cyc,WaveTable::level(freq));
+}
+
+double tableTri(double cyc, double freq) {
+  return waveTable(WF_TRI)->read(cyc,WaveTable::level(freq));
+}
+
+double tablePulse(double cyc, double freq, double duty) {
+  return pulseAt(waveTable(WF_SAW),cyc,WaveTable::level(freq),duty);
+}
+
+//----------------------------------------------------------------------
+// block versions. The table lookup and the level check are hoisted
+// out of the loop; level only changes when the frequency does.
+
+void tableBlock(int form, const double *cyc, const double *freq, double *out, uint32_t n) {
+  WaveTable *t=waveTable(form);
+  double lastFreq=-1;
+  int lvl=0;
+
+  for (uint32_t i=0;i<n;i++) {
+    if (freq[i]!=lastFreq) {
+      lastFreq=freq[i];
+      lvl=WaveTable::level(lastFreq);
+    }
+    out[i]=t->read(cyc[i],lvl);
+  }
+}
+
+void tablePulseBlock(const double *cyc, const double *freq, const double *duty, double *out, uint32_t n) {
+  WaveTable *t=waveTable(WF_SAW);
+  double lastFreq=-1;
+  int lvl=0;
+
+  for (uint32_t i=0;i<n;i++) {
+    if (freq[i]!=lastFreq) {
+      lastFreq=freq[i];
+      lvl=WaveTable::level(lastFreq);
+    }
+    out[i]=pulseAt(t,cyc[i],lvl,duty[i]);
+  }
+}
+
+void tableBipolarBlock(const double *cyc, const double *freq, const double *duty, double *out, uint32_t n) {
+  WaveTable *t=waveTable(WF_SAW);
+  double lastFreq=-1;
+  int lvl=0;
+
+  for (uint32_t i=0;i<n;i++) {
+    if (freq[i]!=lastFreq) {
+      lastFreq=freq[i];
+      lvl=WaveTable::level(lastFreq);
+    }
+    out[i]=bipolarAt(t,cyc[i],lvl,duty[i]);
+  }
+}
@@ -0,0 +1,91 @@
+//----------------------------------------------------------------------
+// Band-limited wavetables for SAW, TRI and the pulse shapes.
+//
+// Drawn straight from the formula these shapes have corners and
+// jumps that contain harmonics far above Nyquist. At a few kHz they
+// fold back down as loud, unrelated tones (aliasing).
+//
+// Instead each shape is built once as a sum of its harmonics into a
+// single cycle table. There is one table per octave ("mip-map"):
+// level k is used for fundamentals from BASE*2^k up to BASE*2^(k+1)
+// and only holds the harmonics that stay under Nyquist at the top of
+// that octave. Lookup is linear interpolation, so the cost is the
+// same at any frequency.
+//
+// Pulses (SQUARE) are made as the difference of two saws offset by
+// the duty cycle, so duty can still change every sample.
+//
+// Tables are built the first time they are used and again if the
+// sample rate changes.
+
+#ifndef EASY_TABLE_HPP
+#define EASY_TABLE_HPP 1
+
+#include <stdint.h>
+#include <math.h>
+
+#define TABLE_SIZE 2048             // samples per cycle, power of 2
+#define TABLE_LEVELS 11             // octaves
+#define TABLE_BASE_FREQ 20.         // bottom of level 0
+
+class WaveTable {
+public:
+  int form;
+  uint32_t builtSR;                           // 0 until built
+  double table[TABLE_LEVELS][TABLE_SIZE+1];   // +1 saves a wrap in read()
+
+  WaveTable(int inform) {
+    form=inform;
+    builtSR=0;
+  }
+
+  void build(uint32_t sr);
+
+  // which octave table to use for this frequency
+
+  static int level(double freq) {
+    freq=fabs(freq);
+    if (freq<2*TABLE_BASE_FREQ) {
+      return 0;
+    }
+    int lvl=ilogb(freq/TABLE_BASE_FREQ);
+    if (lvl>=TABLE_LEVELS) {
+      lvl=TABLE_LEVELS-1;
+    }
+    return lvl;
+  }
+
+  // value at cyc (fraction of a cycle, any range)
+
+  double read(double cyc, int lvl) {
+    double pos=(cyc-floor(cyc))*TABLE_SIZE;
+    uint32_t i=(uint32_t) pos;
+    if (i>=TABLE_SIZE) {           // cyc just under 1 can round up
+      i=TABLE_SIZE-1;
+    }
+    double frac=pos-i;
+    double *t=table[lvl];
+    return t[i]+(t[i+1]-t[i])*frac;
+  }
+};
+
+// table for WF_SAW or WF_TRI, built for the current SR
+
+WaveTable * waveTable(int form);
+
+// single values, for OSC getValue
+
+double tableSaw(double cyc, double freq);
+double tableTri(double cyc, double freq);
+double tablePulse(double cyc, double freq, double duty);
+
+// whole blocks: cyc, freq (and duty) in, out[0..n-1] out
+//
+// tablePulseBlock is +1 for the duty part of the cycle, -1 for the rest (OSC)
+// tableBipolarBlock is -1 then +1 over the duty part, 0 for the rest (SOUND)
+
+void tableBlock(int form, const double *cyc, const double *freq, double *out, uint32_t n);
+void tablePulseBlock(const double *cyc, const double *freq, const double *duty, double *out, uint32_t n);
+void tableBipolarBlock(const double *cyc, const double *freq, const double *duty, double *out, uint32_t n);
+
+#endif
@@ -25,6 +25,13 @@
 
 #include <fstream>
 #include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
 
 extern "C" {
 #include "stdint.h"
@@ -34,47 +41,596 @@ extern "C" {
 
 #include "easy_wav.hpp"
 
-WaveWriter::WaveWriter(int32_t size, uint32_t sampleRate) {
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// frames converted per write in writeFile, must divide PAGE_FRAMES
+
+#define WRITE_BLOCK 4096
+
+// what a page that was never written reads as
+
+static const float silentPage[2*PAGE_FRAMES]={0};
+
+//----------------------------------------------------------------------
+// page table
+
+void PagedBuffer::grow(uint32_t n) {
+  if (n<=count) {
+    return;
+  }
+  std::atomic<float *> *bigger=new std::atomic<float *>[n];
+  for (uint32_t p=0;p<n;p++) {
+    bigger[p]=(p<count) ? pages[p].load() : NULL;
+  }
+  delete[] pages;
+  pages=bigger;
+  count=n;
+}
+
+// two threads can get here for the same page: the first one to fill
+// in the table wins and the other frees its copy
+
+float * PagedBuffer::page(uint32_t p) {
+  float *pg=pages[p].load(std::memory_order_acquire);
+  if (pg!=NULL) {
+    return pg;
+  }
+  float *fresh=(float *)calloc(PAGE_FRAMES*width,sizeof(float));
+  if (fresh==NULL) {
+    printf("%sError - out of memory for output\n%s",RED,WHT);
+    exit(2);
+  }
+  if (pages[p].compare_exchange_strong(pg,fresh,std::memory_order_acq_rel)) {
+    return fresh;
+  }
+  free(fresh);
+  return pg;
+}
+
+const float * PagedBuffer::read(uint32_t pos) {
+  uint32_t p=pos>>PAGE_SHIFT;
+  float *pg=(p<count) ? pages[p].load(std::memory_order_acquire) : NULL;
+  if (pg==NULL) {
+    return silentPage+(pos&PAGE_MASK)*width;
+  }
+  return pg+(pos&PAGE_MASK)*width;
+}
+
+void PagedBuffer::release(uint32_t n) {
+  if (n>count) {
+    n=count;
+  }
+  for (uint32_t p=0;p<n;p++) {
+    free(pages[p].exchange(NULL));
+  }
+}
+
+void PagedBuffer::clear(void) {
+  release(count);
+}
+
+//----------------------------------------------------------------------
+// level summary
+
+// what nothing at all measures as, so the first real value sets it
+
+static const LevelStat noLevel={HUGE_VALF,-HUGE_VALF,0};
+
+static inline void addLevel(LevelStat &st, const LevelStat &e) {
+  if (e.min<st.min) {
+    st.min=e.min;
+  }
+  if (e.max>st.max) {
+    st.max=e.max;
+  }
+  st.sumsq+=e.sumsq;
+}
+
+// calloc so the parts of a long timeline nothing is written to never
+// take any memory. Entries start as silence, which is what the
+// samples they cover are until someone writes there.
+
+void LevelSummary::grow(uint32_t frames) {
+  uint32_t want[SUMMARY_LEVELS];
+  int n=0;
+
+  want[0]=(frames+SUMMARY_FRAMES-1)>>SUMMARY_SHIFT;
+  while ((want[n]>1) && (n+1<SUMMARY_LEVELS)) {
+    want[n+1]=(want[n]+SUMMARY_FAN-1)>>SUMMARY_FAN_SHIFT;
+    n++;
+  }
+  n++;
+
+  if ((levels>0) && (want[0]<=count[0])) {
+    return;
+  }
+
+  for (int lvl=0;lvl<n;lvl++) {
+    LevelStat *st=(LevelStat *) calloc(want[lvl],sizeof(LevelStat));
+    std::atomic<uint8_t> *sl=(std::atomic<uint8_t> *) calloc(want[lvl],1);
+    if ((st==NULL) || (sl==NULL)) {
+      printf("%sError - out of memory for output\n%s",RED,WHT);
+      exit(2);
+    }
+    if (lvl<levels) {
+      memcpy(st,stat[lvl],count[lvl]*sizeof(LevelStat));
+      memcpy((void *) sl,(void *) stale[lvl],count[lvl]);
+      free(stat[lvl]);
+      free((void *) stale[lvl]);
+    }
+    else {
+
+      // a new level on top has nothing worked out yet
+      
+      for (uint32_t i=0;i<want[lvl];i++) {
+        sl[i].store(1,std::memory_order_relaxed);
+      }
+    }
+    stat[lvl]=st;
+    stale[lvl]=sl;
+    count[lvl]=want[lvl];
+  }
+  levels=n;
+}
+
+void LevelSummary::mark(uint32_t from, uint32_t to) {
+  if (from>=to) {
+    return;
+  }
+  for (uint32_t b=from>>SUMMARY_SHIFT;b<=(to-1)>>SUMMARY_SHIFT;b++) {
+    touch(b<<SUMMARY_SHIFT);
+  }
+}
+
+void LevelSummary::scan(uint32_t from, uint32_t to, LevelStat &st) {
+  int width=data->width;
+
+  while (from<to) {
+    const float *f=data->read(from)+lane;
+    uint32_t n=PAGE_FRAMES-(from&PAGE_MASK);
+    if (n>to-from) {
+      n=to-from;
+    }
+    for (uint32_t k=0;k<n;k++) {
+      float v=f[k*width];
+      if (v<st.min) {
+        st.min=v;
+      }
+      if (v>st.max) {
+        st.max=v;
+      }
+      st.sumsq+=(double) v*v;
+    }
+    from+=n;
+  }
+}
+
+// entry i of level lvl, worked out again first if it is stale
+
+const LevelStat & LevelSummary::entry(int lvl, uint32_t i) {
+  if (stale[lvl][i].load(std::memory_order_relaxed)) {
+    LevelStat st=noLevel;
+    if (lvl==0) {
+      scan(i<<SUMMARY_SHIFT,(i+1)<<SUMMARY_SHIFT,st);
+    }
+    else {
+      uint32_t c1=(i+1)<<SUMMARY_FAN_SHIFT;
+      if (c1>count[lvl-1]) {
+        c1=count[lvl-1];
+      }
+      for (uint32_t c=i<<SUMMARY_FAN_SHIFT;c<c1;c++) {
+        addLevel(st,entry(lvl-1,c));
+      }
+    }
+    stat[lvl][i]=st;
+    stale[lvl][i].store(0,std::memory_order_relaxed);
+  }
+  return stat[lvl][i];
+}
+
+// entries i0..i1-1 of level lvl: the whole groups among them come
+// from the level above
+
+void LevelSummary::range(int lvl, uint32_t i0, uint32_t i1, LevelStat &st) {
+  if (lvl+1<levels) {
+    uint32_t p0=(i0+SUMMARY_FAN-1)>>SUMMARY_FAN_SHIFT;
+    uint32_t p1=i1>>SUMMARY_FAN_SHIFT;
+    if (p0<p1) {
+      for (uint32_t i=i0;i<(p0<<SUMMARY_FAN_SHIFT);i++) {
+        addLevel(st,entry(lvl,i));
+      }
+      range(lvl+1,p0,p1,st);
+      i0=p1<<SUMMARY_FAN_SHIFT;
+    }
+  }
+  for (uint32_t i=i0;i<i1;i++) {
+    addLevel(st,entry(lvl,i));
+  }
+}
+
+void LevelSummary::query(uint32_t from, uint32_t to, LevelStat &st) {
+  uint64_t end=(uint64_t) count[0]<<SUMMARY_SHIFT;
+
+  if (from>=to) {
+    return;
+  }
+  if (to>end) {                // past the end is silence
+    addLevel(st,LevelStat{0,0,0});
+    if (from>=end) {
+      return;
+    }
+    to=end;
+  }
+
+  uint32_t b0=(from+SUMMARY_FRAMES-1)>>SUMMARY_SHIFT;
+  uint32_t b1=to>>SUMMARY_SHIFT;
+
+  if (b0>=b1) {
+    scan(from,to,st);
+    return;
+  }
+  scan(from,b0<<SUMMARY_SHIFT,st);
+  range(0,b0,b1,st);
+  scan(b1<<SUMMARY_SHIFT,to,st);
+}
+
+//----------------------------------------------------------------------
+// the one place float samples become 16 bit: rounded to nearest and
+// clipped to the 16 bit range, interleaved L/R into out.
+//
+// SSE2 does 8 frames at a time. cvtps rounds to nearest even, like
+// lrintf, and packs saturates, so both ways give the same samples.
+
+static inline int16_t quantize(float v) {
+  if (v>32767.f) {
+    v=32767.f;
+  }
+  if (v<-32768.f) {
+    v=-32768.f;
+  }
+  return lrintf(v);
+}
+
+static void quantizeBlock(const float *l, const float *r, int16_t *out, uint32_t n) {
+  uint32_t i=0;
+
+#ifdef __SSE2__
+  const __m128 hi=_mm_set1_ps(32767.f);
+  const __m128 lo=_mm_set1_ps(-32768.f);
+
+  for (;i+8<=n;i+=8) {
+    __m128i l0=_mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(l+i),hi),lo));
+    __m128i l1=_mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(l+i+4),hi),lo));
+    __m128i r0=_mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(r+i),hi),lo));
+    __m128i r1=_mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(r+i+4),hi),lo));
+    __m128i ls=_mm_packs_epi32(l0,l1);
+    __m128i rs=_mm_packs_epi32(r0,r1);
+    _mm_storeu_si128((__m128i *) (out+2*i),_mm_unpacklo_epi16(ls,rs));
+    _mm_storeu_si128((__m128i *) (out+2*i+8),_mm_unpackhi_epi16(ls,rs));
+  }
+#endif
+  for (;i<n;i++) {
+    out[2*i]=quantize(l[i]);
+    out[2*i+1]=quantize(r[i]);
+  }
+}
+
+// the same for interleaved frames, which are already in file order:
+// m floats straight through
+
+static void quantizeRun(const float *in, int16_t *out, uint32_t m) {
+  uint32_t i=0;
+
+#ifdef __SSE2__
+  const __m128 hi=_mm_set1_ps(32767.f);
+  const __m128 lo=_mm_set1_ps(-32768.f);
+
+  for (;i+8<=m;i+=8) {
+    __m128i a=_mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(in+i),hi),lo));
+    __m128i b=_mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(in+i+4),hi),lo));
+    _mm_storeu_si128((__m128i *) (out+i),_mm_packs_epi32(a,b));
+  }
+#endif
+  for (;i<m;i++) {
+    out[i]=quantize(in[i]);
+  }
+}
+
+WaveWriter::WaveWriter(int32_t size, uint32_t sampleRate, int layout) {
     static_assert(sizeof(wav) == 44, "");
     this->channels=2;
     this->sr=sampleRate;
-    this->size=size;
+    this->size=0;
+    this->layout=layout;
+
+    if (layout==LAYOUT_INTERLEAVED) {
+      dataL.width=2;
+    }
+    levelL.data=&dataL;
+    levelL.lane=0;
+    levelR.data=(layout==LAYOUT_INTERLEAVED) ? &dataL : &dataR;
+    levelR.lane=(layout==LAYOUT_INTERLEAVED) ? 1 : 0;
     
     if (sampleRate==44100) {   // 16 bit 44.1k
       wav.SamplesPerSec=sampleRate;
       wav.bytesPerSec=wav.SamplesPerSec*2*16/8;
       wav.bitsPerSample=16;
-      data16L=(int16_t *)calloc (size,sizeof(int16_t));
-      data16R=(int16_t *)calloc (size,sizeof(int16_t));
-      scratch16L=(int16_t *)calloc (size,sizeof(int16_t));
-      scratch16R=(int16_t *)calloc (size,sizeof(int16_t));
       MAXVAL=pow(2,15)-1;
     }
     else if (sampleRate==48000) { 
       wav.SamplesPerSec=sampleRate;
       wav.bytesPerSec=wav.SamplesPerSec*2*16/8;
       wav.bitsPerSample=16;
-      data16L=(int16_t *)calloc (size,sizeof(int16_t));
-      data16R=(int16_t *)calloc (size,sizeof(int16_t));
-      scratch16L=(int16_t *)calloc (size,sizeof(int16_t));
-      scratch16R=(int16_t *)calloc (size,sizeof(int16_t));
-
       MAXVAL=pow(2,15)-1;  
     }
     else {
       std::cout << "invalid sample rate / wave format \n";
     }
+
+    // only the page tables are made here, the pages come later
+    
+    if (size>0) {
+      checkSize(size-1);
+    }
+    maxPos=0;
+    writer=NULL;
+    streamedX=0;
+    mapped=false;
+    mapFd=-1;
+    map=NULL;
+    mapFrames=0;
     
     wav.ChunkSize=size+sizeof(wav)-8;
 
 }
 
+//----------------------------------------------------------------------
+// BlockWriter
+
+static void writeAll(int fd, const char * p, size_t len) {
+  while (len>0) {
+    ssize_t w=write(fd,p,len);
+    if (w<0) {
+      if (errno==EINTR) {
+        continue;
+      }
+      printf("%sError - writing the output file failed\n%s",RED,WHT);
+      exit(2);
+    }
+    p+=w;
+    len-=w;
+  }
+}
+
+BlockWriter::BlockWriter(char * filename, const void * header, size_t len) {
+  fd=open(filename,O_WRONLY|O_CREAT|O_TRUNC,0644);
+  if (fd<0) {
+    printf("%sError - can't write %s\n%s",RED,filename,WHT);
+    exit(2);
+  }
+  writeAll(fd,(const char *) header,len);
+
+  buf[0]=new int16_t[2*WRITER_FRAMES];
+  buf[1]=new int16_t[2*WRITER_FRAMES];
+  cur=0;
+  fill=0;
+  pending=NULL;
+  pendingN=0;
+  done=false;
+  thread=std::thread(&BlockWriter::run,this);
+}
+
+BlockWriter::~BlockWriter() {
+  delete[] buf[0];
+  delete[] buf[1];
+}
+
+int16_t * BlockWriter::space(uint32_t &n) {
+  if (n>WRITER_FRAMES-fill) {
+    n=WRITER_FRAMES-fill;
+  }
+  return buf[cur]+2*fill;
+}
+
+void BlockWriter::filled(uint32_t n) {
+  fill+=n;
+  if (fill==WRITER_FRAMES) {
+    handOff();
+  }
+}
+
+// wait for the thread to finish the other buffer, give it this one
+
+void BlockWriter::handOff(void) {
+  std::unique_lock<std::mutex> l(lock);
+  while (pending!=NULL) {
+    change.wait(l);
+  }
+  pending=buf[cur];
+  pendingN=fill;
+  change.notify_all();
+  l.unlock();
+
+  cur^=1;
+  fill=0;
+}
+
+void BlockWriter::run(void) {
+  std::unique_lock<std::mutex> l(lock);
+
+  while (true) {
+    while ((pending==NULL) && !done) {
+      change.wait(l);
+    }
+    if (pending==NULL) {
+      return;                      // done and nothing left
+    }
+    l.unlock();
+    writeAll(fd,(const char *) pending,4*(size_t) pendingN);
+    l.lock();
+    pending=NULL;
+    change.notify_all();
+  }
+}
+
+void BlockWriter::close(const void * header, size_t len) {
+  if (fill>0) {
+    handOff();
+  }
+  {
+    std::unique_lock<std::mutex> l(lock);
+    done=true;
+    change.notify_all();
+  }
+  thread.join();
+
+  if (pwrite(fd,header,len,0)!=(ssize_t) len) {
+    printf("%sError - writing the output file header failed\n%s",RED,WHT);
+    exit(2);
+  }
+  ::close(fd);
+}
+
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 // write the output file
 //
+// The samples go out through streamTo, which is also how -s writes
+// the file a piece at a time while the script is still running.
+// Either way the header is written first with the sizes unknown and
+// filled in at the end.
+
+void WaveWriter::streamOpen (char * filename) {
+  streamedX=0;
+
+  if (mapped) {
+    mapFd=open(filename,O_RDWR|O_CREAT|O_TRUNC,0644);
+    if (mapFd<0) {
+      printf("%sError - can't write %s\n%s",RED,filename,WHT);
+      exit(2);
+    }
+    mapGrow(maxPos);
+    memcpy(map,&wav,sizeof(wav));
+    return;
+  }
+  
+  writer=new BlockWriter(filename,&wav,sizeof(wav));
+}
+
+// make the mapped file big enough for x frames, doubling as needed.
+// The file is extended and mapped again; what is already written
+// stays in the page cache so nothing is copied.
+
+void WaveWriter::mapGrow (uint32_t x) {
+  if ((map!=NULL) && (x<=mapFrames)) {
+    return;
+  }
+  uint32_t frames=(mapFrames>0) ? mapFrames : PAGE_FRAMES;
+  while (frames<x) {
+    frames=frames*2;
+  }
+  size_t bytes=sizeof(wav)+4*(size_t) frames;
+
+  if (map!=NULL) {
+    munmap(map,sizeof(wav)+4*(size_t) mapFrames);
+  }
+  if (ftruncate(mapFd,bytes)!=0) {
+    printf("%sError - can't make the output file %zu bytes\n%s",RED,bytes,WHT);
+    exit(2);
+  }
+  map=(char *) mmap(NULL,bytes,PROT_READ|PROT_WRITE,MAP_SHARED,mapFd,0);
+  if (map==MAP_FAILED) {
+    printf("%sError - can't map the output file\n%s",RED,WHT);
+    exit(2);
+  }
+  mapFrames=frames;
+}
+
+// write out everything up to x and free the pages that are all behind it
+
+void WaveWriter::streamTo (uint32_t x) {
+  uint32_t was=streamedX>>PAGE_SHIFT;
+
+  if (mapped) {
+    mapGrow(x);
+  }
+
+  // blocks stop at multiples of WRITE_BLOCK so none crosses a page
+  
+  uint32_t i=streamedX;
+  while (i<x) {
+    uint32_t n=WRITE_BLOCK-(i&(WRITE_BLOCK-1));
+    if (n>x-i) {
+      n=x-i;
+    }
+    int16_t *out;
+    if (mapped) {
+      out=(int16_t *) (map+sizeof(wav))+2*(size_t) i;
+    }
+    else {
+      out=writer->space(n);
+    }
+    if (layout==LAYOUT_INTERLEAVED) {
+      quantizeRun(dataL.read(i),out,2*n);
+    }
+    else {
+      quantizeBlock(dataL.read(i),dataR.read(i),out,n);
+    }
+    if (!mapped) {
+      writer->filled(n);
+    }
+    i+=n;
+  }
+  // the part of the mapping that is done can go from memory too, the
+  // kernel still writes it to the file
+
+  if (mapped && (x>streamedX)) {
+    size_t os=sysconf(_SC_PAGESIZE);
+    size_t from=(sizeof(wav)+4*(size_t) streamedX+os-1)/os*os;
+    size_t to=(sizeof(wav)+4*(size_t) x)/os*os;
+    if (to>from) {
+      madvise(map+from,to-from,MADV_DONTNEED);
+    }
+  }
+  if (x>streamedX) {
+    streamedX=x;
+  }
+
+  uint32_t done=streamedX>>PAGE_SHIFT;
+  dataL.release(done);
+  dataR.release(done);
+  if (done>was) {
+    levelL.mark(was<<PAGE_SHIFT,done<<PAGE_SHIFT);
+    levelR.mark(was<<PAGE_SHIFT,done<<PAGE_SHIFT);
+  }
+}
+
+// on an error: close the file and remove it, there's no finishing it
+
+void WaveWriter::streamAbandon (char * filename) {
+  if (map!=NULL) {
+    munmap(map,sizeof(wav)+4*(size_t) mapFrames);
+    map=NULL;
+    close(mapFd);
+    mapFd=-1;
+  }
+  if (writer!=NULL) {
+    writer->close(&wav,sizeof(wav));   // lets the thread finish
+    delete writer;
+    writer=NULL;
+  }
+  remove(filename);
+}
 
 int WaveWriter::writeFile (char * filename) {
-   std::ofstream out(filename, std::ios::binary);
+    if (!isOpen()) {
+      streamOpen(filename);
+    }
+
+    printf("%s  writing: %6.2fMB memory, %d samples, %d seconds or %f minutes\n%s",MAG,(maxPos*4/1024./1024.),(uint32_t) maxPos,maxPos/sr,maxPos/sr/60.,WHT);
+
+    streamTo(maxPos);
     
     // wav.ChunkSize=size+sizeof(wav)-8;
     // wav.Subchunk2Size=size+sizeof(wav)-44;
@@ -91,15 +647,25 @@ int WaveWriter::writeFile (char * filename) {
     wav.ChunkSize=4*maxPos+sizeof(wav)-8;
     wav.Subchunk2Size=4*maxPos+sizeof(wav)-44;   
 
-    out.write(reinterpret_cast<const char *>(&wav), sizeof(wav));
-
-    printf("%s  writing: %6.2fMB memory, %d samples, %d seconds or %f minutes\n%s",MAG,(maxPos*4/1024./1024.),maxPos,maxPos/sr,maxPos/sr/60.,WHT);
+    if (mapped) {
 
-    for (uint32_t i = 0; i < maxPos; ++i) {
-      out.write((const char *) &(data16L[i]), 2);
-      out.write((const char *) &(data16R[i]), 2);
+      // patch the header in place and cut the file to the real length
+      
+      memcpy(map,&wav,sizeof(wav));
+      munmap(map,sizeof(wav)+4*(size_t) mapFrames);
+      map=NULL;
+      if (ftruncate(mapFd,sizeof(wav)+4*(size_t) maxPos)!=0) {
+        printf("%sError - can't set the output file length\n%s",RED,WHT);
+        exit(2);
+      }
+      close(mapFd);
+      mapFd=-1;
+      return 0;
     }
-    out.close();
+
+    writer->close(&wav,sizeof(wav));
+    delete writer;
+    writer=NULL;
     return 0;
 }
 
@@ -119,16 +685,21 @@ double WaveWriter::findTime(uint32_t position) {
 }
 
 //----------------------------------------------------------------------
-// if we run out of buffer, double the size
+// if we run out of page table, double the size (as often as it takes).
+// Only the tables are copied, the pages stay where they are.
 
 void WaveWriter::checkSize(uint32_t pos) {
-  if (pos>size) {
-    size=size*2;
-    printf("WAVWRITER: reallocating buffer to %ld samples\n",size);
-    data16L=(int16_t *)realloc ((void *) data16L,size*sizeof(int16_t));
-    data16R=(int16_t *)realloc ((void *) data16R,size*sizeof(int16_t));
-    scratch16L=(int16_t *)realloc ((void *) scratch16L,size*sizeof(int16_t));
-    scratch16R=(int16_t *)realloc ((void *) scratch16R,size*sizeof(int16_t));
+  if (pos>=size) {
+    long want=(size>0) ? size : PAGE_FRAMES;
+    while (pos>=want) {
+      want=want*2;
+    }
+    uint32_t n=(want+PAGE_MASK)>>PAGE_SHIFT;
+    dataL.grow(n);
+    dataR.grow(n);
+    size=(long) n<<PAGE_SHIFT;
+    levelL.grow(size);
+    levelR.grow(size);
   }
 
   // keep tabs on last position written
@@ -140,75 +711,359 @@ void WaveWriter::checkSize(uint32_t pos) {
 
 //----------------------------------------------------------------------
 
-void WaveWriter::setValueL(uint32_t pos,int32_t value, bool scratch) {
+void WaveWriter::noteWrite(uint32_t pos) {
+  if (pos>maxPos) {
+    maxPos=pos;
+  }
+}
+
+void WaveWriter::setValueL(uint32_t pos,float value) {
   checkSize(pos);
+  dataL.set(pos,0,value);
+  levelL.touch(pos);
+  noteWrite(pos);
+}
+  
+void WaveWriter::setValueR(uint32_t pos,float value) {
+  checkSize(pos);
+  if (layout==LAYOUT_INTERLEAVED) {
+    dataL.set(pos,1,value);
+  }
+  else {
+    dataR.set(pos,0,value);
+  }
+  levelR.touch(pos);
+  noteWrite(pos);
+}
+
+//----------------------------------------------------------------------
+
+float WaveWriter::getValueL(uint32_t pos) {
+  return dataL.get(pos,0);
+}
   
-  if (scratch) {
-    scratch16L[pos]=value;
+float WaveWriter::getValueR(uint32_t pos) {
+  if (layout==LAYOUT_INTERLEAVED) {
+    return dataL.get(pos,1);
+  }
+  return dataR.get(pos,0);
+}
+
+//----------------------------------------------------------------------
+// a whole frame at once, chan is 1 for L, 2 for R or 3 for both.
+// Interleaved this is one page lookup and one cache line.
 
-    if (pos>scratchPos) {
-      scratchPos=pos;
+void WaveWriter::setFrame(uint32_t pos, float l, float r, int chan) {
+  checkSize(pos);
+  if (layout==LAYOUT_INTERLEAVED) {
+    bool need=((chan&1) && (l!=0)) || ((chan&2) && (r!=0));
+    float *f=dataL.frame(pos,need);
+    if (f!=NULL) {
+      if (chan&1) {
+        f[0]=l;
+      }
+      if (chan&2) {
+        f[1]=r;
+      }
     }
   }
   else {
-    if (wav.bitsPerSample==16) {
-      data16L[pos]=value;
+    if (chan&1) {
+      dataL.set(pos,0,l);
     }
-    if (pos>maxPos) {
-      maxPos=pos;
+    if (chan&2) {
+      dataR.set(pos,0,r);
     }
   }
+  if (chan&1) {
+    levelL.touch(pos);
+  }
+  if (chan&2) {
+    levelR.touch(pos);
+  }
+  noteWrite(pos);
 }
-  
-void WaveWriter::setValueR(uint32_t pos,int32_t value,bool scratch) {
-  if (scratch) {
-    scratch16R[pos]=value;
-    if (pos>scratchPos) {
-      scratchPos=pos;
-    }
+
+void WaveWriter::getFrame(uint32_t pos, float &l, float &r) {
+  if (layout==LAYOUT_INTERLEAVED) {
+    const float *f=dataL.read(pos);
+    l=f[0];
+    r=f[1];
   }
   else {
-    data16R[pos]=value;
-    if (pos>maxPos) {
-      maxPos=pos;
-    }
+    l=dataL.get(pos,0);
+    r=dataR.get(pos,0);
   }
 }
 
 //----------------------------------------------------------------------
+// n frames at a time, a page at a time underneath. For after-effects
+// that can take a block in, work on it and add the result somewhere.
 
-int32_t WaveWriter::getValueL(uint32_t pos, bool scratch) {
-  int16_t value;
-  
-  if (scratch) {
-    value=scratch16L[pos];
-    return value;
+void WaveWriter::getBlock(uint32_t pos, uint32_t n, float *l, float *r) {
+  while (n>0) {
+    uint32_t run=PAGE_FRAMES-(pos&PAGE_MASK);
+    if (run>n) {
+      run=n;
+    }
+    if (layout==LAYOUT_INTERLEAVED) {
+      const float *f=dataL.read(pos);
+      for (uint32_t k=0;k<run;k++) {
+        l[k]=f[2*k];
+        r[k]=f[2*k+1];
+      }
+    }
+    else {
+      memcpy(l,dataL.read(pos),run*sizeof(float));
+      memcpy(r,dataR.read(pos),run*sizeof(float));
+    }
+    pos+=run;
+    l+=run;
+    r+=run;
+    n-=run;
   }
-  else {
-    value=data16L[pos];
-    return value;
+}
+
+static bool anySet(const float *v, uint32_t n) {
+  for (uint32_t k=0;k<n;k++) {
+    if (v[k]!=0) {
+      return true;
+    }
   }
+  return false;
 }
-  
-int32_t WaveWriter::getValueR(uint32_t pos,bool scratch) {
-  int16_t value;
-  
-  if (scratch) {
-    value=scratch16R[pos];
-    return value;
+
+// adds l and r to the frames on the chan channels. Adding silence
+// to a page that isn't there leaves it not there.
+
+void WaveWriter::addBlock(uint32_t pos, uint32_t n, const float *l, const float *r, int chan) {
+  if (n==0) {
+    return;
   }
-  else {
-    value=data16R[pos];
-    return value;
+  checkSize(pos+n-1);
+  if (chan&1) {
+    levelL.mark(pos,pos+n);
+  }
+  if (chan&2) {
+    levelR.mark(pos,pos+n);
+  }
+  uint32_t last=pos+n-1;
+
+  while (n>0) {
+    uint32_t run=PAGE_FRAMES-(pos&PAGE_MASK);
+    if (run>n) {
+      run=n;
+    }
+    bool needL=(chan&1) && anySet(l,run);
+    bool needR=(chan&2) && anySet(r,run);
+
+    if (layout==LAYOUT_INTERLEAVED) {
+      float *f=dataL.frame(pos,needL || needR);
+      if (f!=NULL) {
+        for (uint32_t k=0;k<run;k++) {
+          if (chan&1) {
+            f[2*k]+=l[k];
+          }
+          if (chan&2) {
+            f[2*k+1]+=r[k];
+          }
+        }
+      }
+    }
+    else {
+      float *f=dataL.frame(pos,needL);
+      if ((chan&1) && (f!=NULL)) {
+        for (uint32_t k=0;k<run;k++) {
+          f[k]+=l[k];
+        }
+      }
+      f=dataR.frame(pos,needR);
+      if ((chan&2) && (f!=NULL)) {
+        for (uint32_t k=0;k<run;k++) {
+          f[k]+=r[k];
+        }
+      }
+    }
+    pos+=run;
+    l+=run;
+    r+=run;
+    n-=run;
+  }
+  noteWrite(last);
+}
+
+// as addBlock but the frames are replaced, for effects that work on
+// the signal in place
+
+void WaveWriter::setBlock(uint32_t pos, uint32_t n, const float *l, const float *r, int chan) {
+  if (n==0) {
+    return;
+  }
+  checkSize(pos+n-1);
+  if (chan&1) {
+    levelL.mark(pos,pos+n);
+  }
+  if (chan&2) {
+    levelR.mark(pos,pos+n);
   }
+  uint32_t last=pos+n-1;
+
+  while (n>0) {
+    uint32_t run=PAGE_FRAMES-(pos&PAGE_MASK);
+    if (run>n) {
+      run=n;
+    }
+    bool needL=(chan&1) && anySet(l,run);
+    bool needR=(chan&2) && anySet(r,run);
+
+    if (layout==LAYOUT_INTERLEAVED) {
+      float *f=dataL.frame(pos,needL || needR);
+      if (f!=NULL) {
+        for (uint32_t k=0;k<run;k++) {
+          if (chan&1) {
+            f[2*k]=l[k];
+          }
+          if (chan&2) {
+            f[2*k+1]=r[k];
+          }
+        }
+      }
+    }
+    else {
+      float *f=dataL.frame(pos,needL);
+      if ((chan&1) && (f!=NULL)) {
+        memcpy(f,l,run*sizeof(float));
+      }
+      f=dataR.frame(pos,needR);
+      if ((chan&2) && (f!=NULL)) {
+        memcpy(f,r,run*sizeof(float));
+      }
+    }
+    pos+=run;
+    l+=run;
+    r+=run;
+    n-=run;
+  }
+  noteWrite(last);
+}
+
+//----------------------------------------------------------------------
+// the largest magnitude in from..to-1 on the chan channels (1 L, 2 R,
+// 3 both), from the level summaries. MIX uses this to see how loud
+// the existing signal is.
+
+float WaveWriter::peak(uint32_t from, uint32_t to, int chan) {
+  LevelStat st=noLevel;
+
+  if (chan&1) {
+    levelL.query(from,to,st);
+  }
+  if (chan&2) {
+    levelR.query(from,to,st);
+  }
+  return fmaxf(0,fmaxf(-st.min,st.max));
 }
 
 //----------------------------------------------------------------------
 // I don't expect the destructor function to ever be called.
 
 WaveWriter::~WaveWriter() {
-      free(data16L);
-      free(data16R);
-      free(scratch16L);
-      free(scratch16R);
+      dataL.clear();
+      dataR.clear();
+}
+
+//----------------------------------------------------------------------
+// readWav
+//
+// The chunks are walked rather than assuming the 44 byte header this
+// file writes, since other programs put LIST and fact chunks in.
+
+static uint32_t le32(const unsigned char *p) {
+  return p[0]|(p[1]<<8)|(p[2]<<16)|((uint32_t) p[3]<<24);
+}
+
+static uint16_t le16(const unsigned char *p) {
+  return p[0]|(p[1]<<8);
 }
+
+float * readWav(const char *filename, uint32_t &frames, int &channels, uint32_t &rate) {
+  FILE *f=fopen(filename,"rb");
+  if (f==NULL) {
+    printf("%sError - can't open %s\n%s",RED,filename,WHT);
+    exit(2);
+  }
+
+  unsigned char head[12];
+  if ((fread(head,1,12,f)!=12) || (memcmp(head,"RIFF",4)!=0) || (memcmp(head+8,"WAVE",4)!=0)) {
+    printf("%sError - %s is not a WAV file\n%s",RED,filename,WHT);
+    exit(2);
+  }
+
+  int format=0;
+  int bits=0;
+  channels=0;
+  rate=0;
+  unsigned char *data=NULL;
+  uint32_t bytes=0;
+
+  unsigned char chunk[8];
+  while ((data==NULL) && (fread(chunk,1,8,f)==8)) {
+    uint32_t len=le32(chunk+4);
+
+    if (memcmp(chunk,"fmt ",4)==0) {
+      unsigned char fmt[40];
+      uint32_t got=(len<sizeof(fmt)) ? len : sizeof(fmt);
+      if ((got<16) || (fread(fmt,1,got,f)!=got)) {
+        break;
+      }
+      format=le16(fmt);
+      channels=le16(fmt+2);
+      rate=le32(fmt+4);
+      bits=le16(fmt+14);
+      if ((format==0xFFFE) && (got>=26)) {   // extensible: the real one
+        format=le16(fmt+24);
+      }
+      fseek(f,len-got+(len&1),SEEK_CUR);
+    }
+    else if (memcmp(chunk,"data",4)==0) {
+      data=(unsigned char *) malloc(len);
+      if (data==NULL) {
+        printf("%sError - out of memory reading %s\n%s",RED,filename,WHT);
+        exit(2);
+      }
+      bytes=fread(data,1,len,f);
+    }
+    else {
+      fseek(f,len+(len&1),SEEK_CUR);        // chunks are padded to even
+    }
+  }
+  fclose(f);
+
+  bool ok=((format==1) && ((bits==16) || (bits==24))) || ((format==3) && (bits==32));
+  if ((data==NULL) || !ok || (channels<1)) {
+    printf("%sError - %s has to be 16 or 24 bit PCM or 32 bit float\n%s",RED,filename,WHT);
+    exit(2);
+  }
+
+  int size=bits/8;
+  frames=bytes/(size*channels);
+  float *out=new float[(size_t) frames*channels];
+
+  for (size_t i=0;i<(size_t) frames*channels;i++) {
+    const unsigned char *p=data+i*size;
+    if (bits==16) {
+      out[i]=(int16_t) le16(p)/32768.f;
+    }
+    else if (bits==24) {
+      int32_t v=(int32_t) (((uint32_t) p[0]<<8)|((uint32_t) p[1]<<16)|((uint32_t) p[2]<<24));
+      out[i]=(v>>8)/8388608.f;
+    }
+    else {
+      uint32_t v=le32(p);
+      memcpy(&out[i],&v,sizeof(float));
+    }
+  }
+  free(data);
+  return out;
+}
+
@@ -23,6 +23,10 @@
 
 #include <fstream>
 #include <iostream>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 extern "C" {
 #include "stdint.h"
@@ -52,6 +56,187 @@ struct WAV_HEADER {
   uint32_t Subchunk2Size;                        // Sampled data length
 };
 
+//----------------------------------------------------------------------
+// Samples kept in pages of PAGE_FRAMES (about a second and a half).
+// Each frame is width floats: one channel, or both interleaved. A
+// page is only allocated when something other than silence is
+// written to it, so memory follows the audio actually made rather
+// than the length of the timeline. Pages never written read back
+// as 0.
+//
+// pages is grown by WaveWriter::checkSize, which must not happen
+// while anything else is reading or writing. Allocating a page is
+// safe from several threads at once.
+
+#define PAGE_SHIFT 16
+#define PAGE_FRAMES (1<<PAGE_SHIFT)
+#define PAGE_MASK (PAGE_FRAMES-1)
+
+class PagedBuffer {
+
+public:
+
+  std::atomic<float *> *pages;
+  uint32_t count;              // entries in pages
+  int width;                   // floats per frame, 1 or 2
+
+  PagedBuffer(void) {
+    pages=NULL;
+    count=0;
+    width=1;
+  }
+
+  void grow(uint32_t n);           // room for n pages
+  float * page(uint32_t p);        // page p, allocated if need be
+  const float * read(uint32_t pos);  // frame pos to the end of its page
+  void release(uint32_t n);        // free pages 0..n-1
+  void clear(void);                // free every page
+
+  // lane is which float of the frame, 0 unless interleaved
+  
+  float get(uint32_t pos, int lane) {
+    uint32_t p=pos>>PAGE_SHIFT;
+    if (p>=count) {
+      return 0;
+    }
+    float *pg=pages[p].load(std::memory_order_acquire);
+    if (pg==NULL) {
+      return 0;
+    }
+    return pg[(pos&PAGE_MASK)*width+lane];
+  }
+
+  void set(uint32_t pos, int lane, float value) {
+    float *f=frame(pos,value!=0);
+    if (f!=NULL) {
+      f[lane]=value;
+    }
+  }
+
+  // the frame at pos to write to. NULL if the page isn't there and
+  // need is false: what is to be written is silence and so is it.
+  
+  float * frame(uint32_t pos, bool need) {
+    float *pg=pages[pos>>PAGE_SHIFT].load(std::memory_order_acquire);
+    if (pg==NULL) {
+      if (!need) {
+        return NULL;
+      }
+      pg=page(pos>>PAGE_SHIFT);
+    }
+    return pg+(pos&PAGE_MASK)*width;
+  }
+};
+
+//----------------------------------------------------------------------
+// A summary of the levels in one channel, so MIX doesn't have to
+// scan every sample it lands on to find out how loud it is there.
+//
+// Level 0 has the min, max and sum of squares for each block of
+// SUMMARY_FRAMES frames. Each level above has one entry for every
+// SUMMARY_FAN entries below it, up to one for the whole timeline. A
+// query takes whole entries from as high up as will fit and only
+// reads samples for the odd frames at each end.
+//
+// Writing a sample just marks its block and the entries above it as
+// stale (once, until they are next read). Stale entries are worked
+// out again when a query needs them, so a long sound costs nothing
+// here until something asks.
+//
+// Marking is safe from several threads. grow and query must have the
+// samples to themselves, like PagedBuffer::grow.
+
+#define SUMMARY_SHIFT 8
+#define SUMMARY_FRAMES (1<<SUMMARY_SHIFT)
+#define SUMMARY_FAN_SHIFT 4
+#define SUMMARY_FAN (1<<SUMMARY_FAN_SHIFT)
+#define SUMMARY_LEVELS 8
+
+struct LevelStat {
+  float min;
+  float max;
+  double sumsq;
+};
+
+class LevelSummary {
+
+public:
+
+  PagedBuffer *data;           // where the samples are
+  int lane;                    // and which float of the frame
+
+  int levels;
+  uint32_t count[SUMMARY_LEVELS];            // entries per level
+  LevelStat *stat[SUMMARY_LEVELS];
+  std::atomic<uint8_t> *stale[SUMMARY_LEVELS];
+
+  LevelSummary(void) {
+    data=NULL;
+    lane=0;
+    levels=0;
+  }
+
+  void grow(uint32_t frames);      // cover frames 0..frames-1
+  void query(uint32_t from, uint32_t to, LevelStat &st);  // adds to st
+  void mark(uint32_t from, uint32_t to);   // frames changed by other means
+
+  void touch(uint32_t pos) {
+    uint32_t i=pos>>SUMMARY_SHIFT;
+    if (stale[0][i].load(std::memory_order_relaxed)) {
+      return;                  // and so is everything above it
+    }
+    for (int lvl=0;lvl<levels;lvl++) {
+      stale[lvl][i].store(1,std::memory_order_relaxed);
+      i>>=SUMMARY_FAN_SHIFT;
+    }
+  }
+
+private:
+
+  const LevelStat & entry(int lvl, uint32_t i);
+  void range(int lvl, uint32_t i0, uint32_t i1, LevelStat &st);
+  void scan(uint32_t from, uint32_t to, LevelStat &st);
+};
+
+//----------------------------------------------------------------------
+// Writes 16 bit stereo frames to a file in big blocks from a thread
+// of its own. There are two buffers: the caller fills one while the
+// thread is writing out the other.
+
+#define WRITER_FRAMES (1<<18)      // frames per buffer, 1MB
+
+class BlockWriter {
+
+public:
+
+  BlockWriter(char * filename, const void * header, size_t len);
+  ~BlockWriter();
+
+  int16_t * space(uint32_t &n);    // room for n frames, n cut to fit
+  void filled(uint32_t n);         // after putting n frames there
+  void close(const void * header, size_t len);  // the rest, then header
+
+private:
+
+  int fd;
+  int16_t *buf[2];
+  int cur;                         // the one being filled
+  uint32_t fill;                   // frames in it
+
+  std::thread thread;
+  std::mutex lock;
+  std::condition_variable change;
+  int16_t *pending;                // given to the thread, NULL once written
+  uint32_t pendingN;
+  bool done;
+
+  void handOff(void);
+  void run(void);
+};
+
+#define LAYOUT_PLANAR 0
+#define LAYOUT_INTERLEAVED 1
+
 class WaveWriter {
 
 public:
@@ -61,41 +246,81 @@ public:
   uint32_t  sr;           // sample rate, either 44100 or 48000
   uint16_t bitsPerSample; // either 16 or nothing: 24 bit stuff deleted
 
-  long     size;          // allocated buffer size
+  long     size;          // frames the page tables cover
   uint32_t MAXVAL;        // maximum sample value for resolution
-  uint32_t maxPos;        // maximum sample location used
-  uint32_t scratchPos;    // maximum scratch location used 
+  std::atomic<uint32_t> maxPos;  // maximum sample location used, can be
+                                 // raised while commands run (easy_jobs)
 
-  // two output data buffers (L/R) for each supported format
-  // 24 bit deleted: it's all 16 bit here
+  // the output is kept as float (L/R) while the script runs, on the
+  // same scale as the 16 bit samples (+/-MAXVAL). Sounds and
+  // after-effects all work on these and nothing is rounded or clipped
+  // until writeFile turns them into 16 bit.
+  //
+  // With LAYOUT_PLANAR each channel has its own buffer. With
+  // LAYOUT_INTERLEAVED (-i) both are in dataL as L,R
+  // pairs like the file, so a stereo frame is one cache line and
+  // dataR goes unused. Use setFrame/getFrame and the layout doesn't
+  // matter.
   
-  int16_t   *data16L;
-  int16_t   *data16R;
+  int layout;
+  PagedBuffer dataL;
+  PagedBuffer dataR;
+  LevelSummary levelL;
+  LevelSummary levelR;
 
-  // scratch buffers are used for mixing calculations
-  
-  int16_t   *scratch16L;
-  int16_t   *scratch16R;
+  // the file being written, from streamOpen until writeFile is done.
+  // Everything before streamedX is in it and those pages are gone.
+
+  BlockWriter *writer;
+  uint32_t streamedX;
+
+  // or with mapped set (-m) the file is mapped into memory and the
+  // samples are quantized straight into it. mapFrames is how many
+  // frames the file has room for so far.
+
+  bool mapped;
+  int mapFd;
+  char *map;
+  uint32_t mapFrames;
   
-  WaveWriter(int32_t size, uint32_t sampleRate);
+  WaveWriter(int32_t size, uint32_t sampleRate, int layout=LAYOUT_PLANAR);
   ~WaveWriter();
 
   int32_t findPosition(double targetTime);
   double findTime(uint32_t position);
-  void setValueL(uint32_t pos,int32_t value, bool scratch);
-  void setValueR(uint32_t pos,int32_t value, bool scratch);
-  int32_t getValueL(uint32_t pos, bool scratch);
-  int32_t getValueR(uint32_t pos, bool scratch);
+  void setValueL(uint32_t pos,float value);
+  void setValueR(uint32_t pos,float value);
+  float getValueL(uint32_t pos);
+  float getValueR(uint32_t pos);
+  void setFrame(uint32_t pos, float l, float r, int chan);
+  void getFrame(uint32_t pos, float &l, float &r);
+  void getBlock(uint32_t pos, uint32_t n, float *l, float *r);
+  void addBlock(uint32_t pos, uint32_t n, const float *l, const float *r, int chan);
+  void setBlock(uint32_t pos, uint32_t n, const float *l, const float *r, int chan);
+  float peak(uint32_t from, uint32_t to, int chan);
   int writeFile (char * filename);
+  void streamOpen (char * filename);
+  void streamTo (uint32_t x);
+  void streamAbandon (char * filename);
+  void mapGrow (uint32_t x);
+
+  bool isOpen (void) {
+    return (writer!=NULL) || (map!=NULL);
+  }
   void checkSize(uint32_t pos);
+  void noteWrite(uint32_t pos);
 
   void DEBUG (uint32_t startX,uint32_t endX) {
     uint32_t i;
     
     for (i=startX; i<endX; i++) {
-      std::cout << "index " << i << " L " << data16L[i] << " R " << data16R[i] << "\n";
+      std::cout << "index " << i << " L " << getValueL(i) << " R " << getValueR(i) << "\n";
     }
   }
   
 };
 
+// reads a WAV file (16 or 24 bit PCM, or 32 bit float) as floats from
+// -1 to 1, the channels of each frame together. Exits if it can't.
+
+float * readWav(const char *filename, uint32_t &frames, int &channels, uint32_t &rate);
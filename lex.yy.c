@@ -351,8 +351,8 @@ static void yynoreturn yy_fatal_error ( const char* msg  );
 	(yy_hold_char) = *yy_cp; \
 	*yy_cp = '\0'; \
 	(yy_c_buf_p) = yy_cp;
-#define YY_NUM_RULES 103
-#define YY_END_OF_BUFFER 104
+#define YY_NUM_RULES 124
+#define YY_END_OF_BUFFER 125
 /* This struct is not used in this scanner,
    but its presence is necessary. */
 struct yy_trans_info
@@ -360,42 +360,46 @@ struct yy_trans_info
 	flex_int32_t yy_verify;
 	flex_int32_t yy_nxt;
 	};
-static const flex_int16_t yy_accept[306] =
+static const flex_int16_t yy_accept[379] =
     {   0,
-       93,   93,  104,  103,    2,    3,  103,    1,   97,   87,
-       85,    5,   86,  103,   88,   93,   84,   90,   92,   92,
-       92,   92,   92,   92,   92,   92,   92,   92,   92,   92,
-       92,   92,   92,   92,   92,   92,   92,   92,   92,   92,
-       92,    2,    0,    1,   89,   98,   97,    0,   93,    0,
-        0,   95,   96,   83,   92,   92,   92,   92,   92,   92,
-       92,   92,   92,   92,   92,   92,   92,   92,   92,   92,
-       92,   92,   92,   92,   92,   92,   92,   92,   92,   92,
-       92,   92,   92,   92,   92,   92,   92,   92,   92,   92,
-       92,   92,   92,   92,    4,   92,   92,   92,    0,  102,
-
-        0,  101,  100,    0,   94,   92,   92,   92,   92,   11,
-       92,   92,   92,   92,   92,   92,   78,   92,   92,   92,
-       92,   92,   92,   92,   92,   92,   92,   19,   92,   92,
-       92,   37,   92,   92,   92,   92,   92,   92,   92,   92,
-       92,   92,   47,   41,   92,   92,   92,   92,   92,   92,
-       92,   92,   92,   48,   12,   92,    0,   99,   82,   92,
-       92,   23,   92,   92,    8,   92,   92,   44,   43,   92,
-       32,   75,   92,   34,   10,   71,   72,   92,   92,    7,
-       92,   92,   92,   92,   92,   92,   92,   92,   40,   92,
-       92,   92,   66,   67,   68,   92,   92,   92,   92,   92,
-
-       45,   92,   92,    0,   92,   49,   25,   14,   16,   92,
-       91,    0,   92,   63,   64,   65,   92,   22,    0,   92,
-       76,   92,   92,   13,   15,   92,   57,   58,   59,    0,
-       92,   92,   50,   92,   92,    9,   92,   42,   92,   92,
-       92,   92,   92,   92,    6,   33,   92,   20,   92,   77,
-       92,   92,    0,   92,   92,   79,   92,   30,   92,   92,
-       74,   92,   92,   60,   61,   62,   17,   54,   55,   56,
-       39,   92,   73,   92,   24,   27,   92,   46,   77,   51,
-       52,   53,   69,   70,   81,   26,   28,   79,   35,   31,
-       18,   74,   92,   92,   38,   92,   21,   92,   92,    0,
-
-       29,   36,   80,   80,    0
+      114,  114,  125,  124,    2,    3,  124,    1,  118,  108,
+      106,    5,  107,  124,  109,  114,  105,  111,  113,  113,
+      113,  113,  113,  113,  113,  113,  113,  113,  113,  113,
+      113,  113,  113,  113,   39,  113,  113,  113,  113,  113,
+        0,  110,  119,  118,    0,    0,    0,  116,  117,  104,
+      113,  113,  113,  113,  113,  113,  113,  113,  113,  113,
+      113,  113,  113,  113,  113,  113,  113,  113,  113,  113,
+      113,   18,  113,  113,  113,  113,  113,  113,  113,  113,
+      113,  113,  113,  113,  113,  113,  113,  113,  113,  113,
+      113,  113,  113,  113,  113,  113,  113,  113,  113,  113,
+      113,    4,  113,  113,  113,    0,  123,    0,  122,  121,
+        0,  115,  113,  113,  113,  113,   11,  113,  113,  113,
+      113,  113,  113,  113,  113,  113,  113,  113,   99,  113,
+      113,  113,  113,  113,  113,  113,  113,  113,  113,  113,
+      113,  113,   24,  113,  113,  113,  113,  113,   54,  113,
+      113,  113,  113,  113,  113,  113,  113,  113,  113,  113,
+      113,  113,   64,  113,   58,  113,  113,  113,  113,  113,
+      113,  113,  113,   30,  113,  113,  113,   65,   12,  113,
+        0,  120,  103,  113,  113,   28,  113,  113,   71,  113,
+        8,  113,  113,  113,  113,   61,   60,  113,  113,   48,
+       96,  113,  113,   50,   10,   92,   93,  113,  113,  113,
+        7,  113,  113,  113,  113,  113,  113,  113,  113,  113,
+      113,  113,   68,  113,   57,  113,  113,  113,   87,   88,
+       89,  113,  113,  113,   32,   53,  113,  113,   62,   33,
+      113,  113,  113,    0,  113,   66,   41,   14,   16,  113,
+      112,    0,  113,   84,   85,   86,  113,  113,  113,   27,
+       69,    0,   20,  113,   97,  113,  113,  113,  113,   13,
+       15,  113,  113,   78,   79,   80,    0,  113,  113,  113,
+       67,  113,   38,  113,  113,  113,    9,  113,   59,  113,
+      113,  113,  113,  113,  113,    6,   49,  113,   25,  113,
+      113,   98,  113,  113,    0,  113,  113,  113,  113,  100,
+      113,  113,   46,  113,   34,  113,  113,   95,  113,  113,
+      113,  113,   81,   82,   83,   19,   22,  113,   75,   76,
+       77,   56,  113,   94,  113,   29,   43,  113,   63,   40,
+       72,   73,   74,   90,   91,  102,   42,   44,  113,  113,
+       51,  113,   47,  113,   23,   35,  113,  113,  113,   17,
+       55,  113,   26,  113,   37,   31,   36,  113,  113,  113,
+        0,   70,   45,   52,  113,  101,   21,    0
     } ;
 
 static const YY_CHAR yy_ec[256] =
@@ -410,10 +414,9 @@ static const YY_CHAR yy_ec[256] =
        20,   21,   20,   20,   20,   20,   20,   20,   20,   22,
        20,   20,   23,   20,   20,   20,   20,   20,   20,   24,
         1,    1,    1,    1,   25,    1,   26,   27,   28,   29,
-
        30,   31,   32,   33,   34,   20,   35,   36,   37,   38,
        39,   40,   41,   42,   43,   44,   45,   46,   47,   48,
-       49,   24,    1,    1,    1,    1,    1,    1,    1,    1,
+       49,   50,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
@@ -421,7 +424,6 @@ static const YY_CHAR yy_ec[256] =
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
@@ -430,195 +432,261 @@ static const YY_CHAR yy_ec[256] =
         1,    1,    1,    1,    1
     } ;
 
-static const YY_CHAR yy_meta[50] =
+static const YY_CHAR yy_meta[51] =
     {   0,
-        1,    1,    2,    3,    1,    1,    1,    1,    4,    1,
-        4,    1,    1,    5,    5,    5,    5,    1,    1,    6,
-        6,    6,    6,    6,    7,    6,    6,    6,    6,    6,
-        6,    6,    6,    6,    6,    6,    6,    6,    6,    6,
-        6,    6,    6,    6,    6,    6,    6,    6,    6
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1
     } ;
 
-static const flex_int16_t yy_base[318] =
+static const flex_int16_t yy_base[379] =
     {   0,
-        0,    0,  384,  385,   48,  385,    0,    0,  376,  385,
-      385,  385,  385,   39,  385,   50,   44,  385,    0,  358,
-        0,    0,   40,   37,   44,  336,   36,   49,  354,  341,
-      344,   56,   53,  338,   49,   56,   70,   72,   73,  337,
-      345,   95,  362,    0,  385,  111,  385,  105,    0,  121,
-      349,  385,  385,  125,    0,    0,   80,  333,  327,  334,
-       85,  333,  326,  337,  322,  336,  330,  334,  320,  331,
-      320,  331,  330,  326,  317,  317,  306,  115,  325,  308,
-      325,  314,   44,  106,  317,  301,  306,  320,   72,  300,
-      299,  316,  119,  305,    0,  307,  304,  310,    0,  385,
-
-      314,  385,  385,  146,  385,  293,  294,  306,  295,    0,
-      290,  299,  295,  130,  304,  280,    0,  284,  297,  289,
-      284,  115,  288,  288,  278,  281,  275,    0,  285,  275,
-      289,    0,  276,  272,  271,  273,  283,  281,  265,  150,
-      275,  275,    0,    0,  267,  276,  275,  266,  277,  298,
-      258,  257,  269,    0,  139,  266,  292,  385,  278,  261,
-      156,    0,  257,  249,    0,  288,  246,    0,    0,  248,
-        0,    0,  135,    0,  159,    0,    0,  244,  162,    0,
-      284,  261,  244,  255,  251,  238,  252,  251,  237,  142,
-      253,  244,    0,    0,    0,  235,  238,  231,  244,  235,
-
-        0,  243,  229,  266,  239,    0,    0,    0,    0,  238,
-      385,  172,  230,    0,    0,    0,  232,    0,  261,  230,
-        0,  225,  217,    0,    0,  232,    0,    0,    0,  256,
-      223,  230,    0,  167,  213,    0,  175,    0,  219,  225,
-      210,  211,  225,  222,    0,    0,  222,    0,  219,    0,
-      178,  181,  184,  218,  194,    0,  197,    0,  185,  198,
-        0,  188,  179,    0,    0,    0,    0,    0,    0,    0,
-        0,  180,    0,  190,    0,    0,  177,    0,    0,    0,
-        0,    0,    0,    0,  385,    0,    0,    0,    0,    0,
-        0,    0,  134,  116,    0,  144,    0,   68,   70,   47,
-
-        0,    0,    0,    0,  385,  198,  205,  208,  211,  216,
-      220,  224,  226,  229,  232,  237,  240
+        1,    0,  730,  730,   50,  730,   44,   94,   49,  730,
+      730,  730,  730,  131,  730,  142,  136,  730,  172,  132,
+      142,  140,   12,  124,  197,   36,  121,   25,   63,  194,
+      157,  128,  195,  201,    0,  211,  218,  230,  131,  150,
+      178,  730,  254,  730,    0,  251,  204,  730,  730,    0,
+      200,  186,  186,  211,  202,  214,  203,  219,  231,  229,
+      243,  236,  234,  250,  246,  252,  246,  241,  254,  245,
+      254,    0,  260,  261,  259,  252,  254,  245,  267,  265,
+      270,  256,  260,  277,  266,  269,  271,  272,  274,  271,
+      267,  285,  290,  284,  272,  276,  297,  297,  285,  301,
+      291,    0,  295,  294,  302,  321,  730,  348,  730,  730,
+      359,  730,  288,  291,  311,  338,    0,  349,  339,  337,
+      348,  335,  347,  342,  357,  360,  341,  339,    0,  345,
+      360,  348,  356,  353,  380,  366,  364,  366,  358,  363,
+      364,  360,    0,  372,  364,  382,  381,  367,    0,  371,
+      368,  370,  379,  372,  376,  388,  388,  374,  405,  389,
+      391,  388,    0,  397,    0,  387,  398,  399,  400,  393,
+      406,  401,  430,    0,  393,  394,  408,    0,  423,  409,
+      437,  730,  425,  410,  430,    0,  411,  411,    0,  406,
+        0,  414,  449,  425,  410,    0,    0,  414,  418,    0,
+        0,  424,  429,    0,  444,    0,    0,  422,  419,  450,
+        0,  464,  443,  444,  429,  442,  431,  441,  445,  431,
+      443,  448,    0,  449,  437,  442,  456,  449,    0,    0,
+        0,  442,  448,  443,    0,    0,  458,  451,    0,    0,
+      461,  449,  462,  489,  464,    0,    0,    0,    0,  465,
+      730,  482,  463,    0,    0,    0,  467,  463,  477,    0,
+        0,  536,    0,  470,    0,  469,  468,  462,  466,    0,
+        0,  488,  512,    0,    0,    0,  583,  499,  507,  516,
+        0,  501,  531,  505,  506,  525,    0,  537,    0,  518,
+      531,  544,  547,  563,  562,    0,    0,  564,    0,  563,
+      551,  630,  580,  583,  621,  570,  553,  568,  565,  635,
+      596,  595,    0,  598,    0,  600,  618,  649,  611,  619,
+      612,  624,    0,    0,    0,    0,    0,  623,    0,    0,
+        0,    0,  620,    0,  632,    0,    0,  637,    0,    0,
+        0,    0,    0,    0,    0,  730,    0,    0,  625,  626,
+        0,  640,    0,  628,    0,    0,  638,  639,  649,    0,
+        0,  672,    0,  647,    0,    0,    0,  630,  635,  644,
+      677,    0,    0,    0,  639,  679,    0,  730
     } ;
 
-static const flex_int16_t yy_def[318] =
+static const flex_int16_t yy_def[379] =
     {   0,
-      305,    1,  305,  305,  305,  305,  306,  307,  305,  305,
-      305,  305,  305,  305,  305,  305,  305,  305,  308,  308,
-      308,  308,  308,  308,  308,  308,  308,  308,  308,  308,
-      308,  308,  308,  308,  308,  308,  308,  308,  308,  308,
-      308,  305,  306,  307,  305,  305,  305,  305,   16,  305,
-      305,  305,  305,  305,  308,  308,  308,  308,  308,  308,
-      308,  308,  308,  308,  308,  308,  308,  308,  308,  308,
-      308,  308,  308,  308,  308,  308,  308,  308,  308,  308,
-      308,  308,  308,  308,  308,  308,  308,  308,  308,  308,
-      308,  308,  308,  308,  308,  308,  308,  308,  309,  305,
-
-      305,  305,  305,  305,  305,  308,  308,  308,  308,  308,
-      308,  308,  308,  308,  308,  308,  308,  308,  308,  308,
-      308,  308,  308,  308,  308,  308,  308,  308,  308,  308,
-      308,  308,  308,  308,  308,  308,  308,  308,  308,  308,
-      308,  308,  308,  308,  308,  308,  308,  308,  308,  308,
-      308,  308,  308,  308,  308,  308,  309,  305,  305,  308,
-      308,  308,  308,  308,  308,  308,  308,  308,  308,  308,
-      308,  308,  308,  308,  308,  308,  308,  308,  308,  308,
-      308,  308,  308,  308,  308,  308,  308,  308,  308,  308,
-      308,  308,  308,  308,  308,  308,  308,  308,  308,  308,
-
-      308,  308,  308,  310,  308,  308,  308,  308,  308,  308,
-      305,  305,  308,  308,  308,  308,  308,  308,  311,  308,
-      308,  308,  308,  308,  308,  308,  308,  308,  308,  312,
-      308,  308,  308,  308,  308,  308,  308,  308,  308,  308,
-      308,  308,  308,  308,  308,  308,  308,  308,  308,  313,
-      308,  308,  305,  308,  308,  314,  308,  308,  308,  308,
-      315,  308,  308,  308,  308,  308,  308,  308,  308,  308,
-      308,  308,  308,  308,  308,  308,  308,  308,  313,  308,
-      308,  308,  308,  308,  305,  308,  308,  314,  308,  308,
-      308,  315,  308,  308,  308,  308,  308,  308,  308,  316,
-
-      308,  308,  317,  317,    0,  305,  305,  305,  305,  305,
-      305,  305,  305,  305,  305,  305,  305
+      378,    1,  378,  378,  378,  378,  378,  378,  378,  378,
+      378,  378,  378,  378,  378,  378,  378,  378,  378,   19,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+        7,  378,   14,  378,   14,  378,  378,  378,  378,   17,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   19,   19,   19,  378,  378,  378,  378,  378,
+      378,  378,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+      106,  378,  378,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   19,  378,   19,   19,   19,   19,   19,   19,
+      378,  378,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,  378,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   19,   19,   19,   19,  378,   19,   19,   19,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,  244,   19,   19,  378,   19,   19,   19,   19,  262,
+       19,   19,   19,   19,   19,   19,   19,  277,   19,   19,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   19,   19,   19,  378,   19,   19,   19,   19,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+      378,   19,   19,   19,   19,  371,   19,    0
     } ;
 
-static const flex_int16_t yy_nxt[435] =
+static const flex_int16_t yy_nxt[781] =
     {   0,
-        4,    5,    6,    5,    7,    8,    9,   10,   11,   12,
-       13,   14,   15,   16,   16,   16,   16,   17,   18,   19,
-       20,   21,   22,   19,   19,   23,   24,   25,   26,   27,
-       28,   29,   20,   30,   31,   32,   33,   34,   35,   36,
-       19,   37,   38,   39,   19,   40,   41,   19,   19,   42,
-      300,   42,   46,   46,   46,   46,   47,   54,   54,   54,
-       54,   48,   60,   49,   49,   49,   49,   50,   57,   62,
-       51,   52,   53,   66,   68,   61,   58,   63,   76,   64,
-      136,  137,   51,   67,   59,   74,   77,   69,   81,   52,
-       70,   79,   53,   80,   75,   83,   42,   86,   42,   84,
-
-       82,   87,   93,   85,   88,   89,   94,  146,  106,  147,
-       90,   95,   91,  302,   96,  301,   92,  100,   46,   46,
-       46,   46,  107,  111,   46,   46,   46,   46,  112,  176,
-      177,  101,  102,  103,  104,  104,  104,  104,   54,   54,
-       54,   54,  129,  101,  151,  138,  139,  300,  130,  299,
-      102,  140,  141,  103,  208,  209,  152,  167,  131,  159,
-      159,  159,  159,  168,  193,  194,  195,  298,  222,  169,
-      214,  215,  216,  223,  224,  225,  227,  228,  229,  196,
-      239,  264,  265,  266,  240,  253,  253,  253,  253,  268,
-      269,  270,  280,  281,  282,  283,  284,  285,  285,  285,
-
-      285,   43,   43,   43,   43,   44,  297,   44,   44,   44,
-       44,   44,   55,   55,   55,  157,  157,  157,  250,  296,
-      295,  250,  256,  294,  293,  256,  261,  291,  290,  261,
-      279,  279,  279,  288,  288,  288,  292,  292,  292,  303,
-      289,  287,  303,  303,  304,  304,  304,  286,  278,  277,
-      276,  275,  274,  273,  272,  271,  267,  263,  262,  230,
-      260,  259,  258,  257,  219,  255,  254,  252,  251,  204,
-      249,  248,  247,  246,  245,  244,  243,  242,  241,  238,
-      237,  236,  235,  234,  233,  232,  231,  230,  226,  221,
-      220,  219,  218,  217,  213,  212,  211,  210,  207,  206,
-
-      205,  204,  203,  202,  201,  200,  199,  198,  197,  192,
-      191,  190,  189,  188,  187,  186,  185,  184,  183,  182,
-      181,  180,  179,  178,  175,  174,  173,  172,  171,  170,
-      166,  165,  164,  163,  162,  161,  160,  158,  156,  155,
-      154,  153,  150,  149,  148,  145,  144,  143,  142,  135,
-      134,  133,  132,  128,  127,  126,  125,  124,  123,  122,
-      121,  120,  119,  118,  117,  116,  115,  114,  113,  110,
-      109,  108,  105,   99,   98,   97,   78,   73,   72,   71,
-       65,   56,   45,  305,    3,  305,  305,  305,  305,  305,
-      305,  305,  305,  305,  305,  305,  305,  305,  305,  305,
-
-      305,  305,  305,  305,  305,  305,  305,  305,  305,  305,
-      305,  305,  305,  305,  305,  305,  305,  305,  305,  305,
-      305,  305,  305,  305,  305,  305,  305,  305,  305,  305,
-      305,  305,  305,  305
+      378,    4,    5,    6,    5,    7,    8,    9,   10,   11,
+       12,   13,   14,   15,   16,   16,   16,   16,   17,   18,
+       19,   19,   19,   19,   19,   19,   20,   21,   22,   23,
+       24,   25,   26,   27,   28,   29,   30,   31,   32,   33,
+       34,   35,   36,   37,   38,   19,   39,   40,   19,   19,
+       19,    5,   41,    5,   41,   42,   63,   41,   41,   41,
+       41,   70,   73,   41,   41,   41,   41,   41,   41,   41,
+       41,   41,   41,   41,   41,   41,   41,   41,   41,   41,
+       41,   41,   41,   41,   41,   41,   41,   41,   41,   41,
+       41,   41,   41,   41,    8,    8,   74,    8,    8,    8,
+        8,    8,    8,    8,    8,    8,    8,    8,    8,    8,
+        8,    8,    8,    8,    8,    8,    8,    8,    8,    8,
+        8,    8,    8,    8,    8,    8,    8,    8,    8,    8,
+        8,    8,    8,    8,    8,    8,    8,    8,    8,    8,
+        8,    8,    8,    8,   43,   43,   43,   43,   44,   50,
+       50,   50,   50,   45,   71,   16,   16,   16,   16,   46,
+       51,   64,   47,   48,   49,   58,   79,   54,   52,  104,
+       72,   65,   59,   60,   47,   61,   53,   55,   62,  105,
+       56,   48,   77,   57,   49,   19,   19,   19,   19,  106,
+       78,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   66,   75,  115,   80,   83,  112,  113,  116,
+       67,  119,   76,   84,   85,   68,   87,   81,   69,   82,
+       88,  122,  114,   91,   89,   86,  117,   92,  118,   90,
+       93,   94,  120,  112,  123,   99,   95,  121,   96,  100,
+      107,   97,   98,  101,  111,  111,  111,  111,  102,  124,
+      125,  103,  126,  127,  108,  109,  110,  128,  129,  130,
+      131,  132,  133,  134,  135,  136,  108,  137,  138,  139,
+      140,  142,  143,  109,  144,  148,  110,  149,  141,  150,
+      145,  151,  152,  153,  154,  161,  146,  155,  156,  162,
+      147,  157,  158,  163,  164,  166,  170,  159,  160,  167,
+      171,  168,  172,  173,  174,  165,  175,  177,  178,  179,
+      180,  184,  185,  169,  181,  181,  181,  181,  176,  186,
+      181,  181,  181,  181,  181,  181,  181,  181,  181,  181,
+      181,  181,  181,  181,  181,  181,  181,  181,  181,  181,
+      181,  181,  181,  181,  181,  181,  181,  181,  181,  181,
+      181,  182,  183,  183,  183,  183,  187,  188,  189,  190,
+      191,  192,  193,  194,  195,  198,  199,  200,  201,  202,
+      196,  203,  204,  205,  206,  207,  197,  182,  208,  209,
+      210,  211,  212,  213,  214,  215,  216,  217,  218,  219,
+      220,  221,  222,  223,  224,  225,  226,  227,  228,  229,
+      230,  231,  233,  234,  235,  236,  237,  238,  239,  240,
+      241,  242,  243,  244,  232,  245,  246,  247,  248,  249,
+      250,  251,  252,  253,  254,  255,  256,  257,  258,  260,
+      259,  261,  262,  263,  264,  265,  266,  267,  269,  270,
+      271,  272,  268,  273,  274,  275,  276,  277,  278,  279,
+      280,  281,  282,  283,  284,  285,  286,  287,  288,  289,
+      290,  292,  293,  294,  291,  295,  296,  297,  298,  299,
+      300,  301,  244,  303,  304,  305,  305,  305,  305,  306,
+      307,  308,  309,  311,  312,  313,  314,  315,  302,  302,
+      302,  302,  302,  316,  302,  302,  302,  302,  302,  302,
+      302,  302,  302,  302,  302,  302,  302,  302,  302,  302,
+      302,  302,  302,  302,  302,  302,  302,  302,  302,  262,
+      317,  319,  320,  321,  322,  323,  324,  325,  326,  327,
+      328,  329,  330,  331,  332,  310,  310,  310,  310,  310,
+      333,  310,  310,  310,  310,  310,  310,  310,  310,  310,
+      310,  310,  310,  310,  310,  310,  310,  310,  310,  310,
+      310,  310,  310,  310,  310,  310,  277,  334,  335,  336,
+      337,  338,  339,  340,  341,  342,  343,  344,  345,  347,
+      348,  349,  318,  318,  318,  318,  318,  350,  318,  318,
+      318,  318,  318,  318,  318,  318,  318,  318,  318,  318,
+      318,  318,  318,  318,  318,  318,  318,  318,  318,  318,
+      318,  318,  318,  378,  346,  346,  346,  346,  378,  351,
+      352,  353,  354,  302,  302,  302,  302,  355,  310,  310,
+      310,  310,  378,  356,  302,  357,  358,  359,  360,  310,
+      361,  362,  318,  318,  318,  318,  363,  364,  365,  366,
+      367,  368,  369,  318,  370,  371,  372,  373,  374,  375,
+      371,  377,  378,  378,  378,  378,  378,  378,  378,  378,
+      378,  378,  376,  376,  376,  376,  376,  376,  376,  376,
+      376,  376,  376,  376,  376,  376,  376,  376,  376,  376,
+      376,  376,  376,  376,  376,  376,  376,  376,  376,  376,
+      376,  376,  376,  376,  376,  376,  376,  378,  378,    3,
+      378,  378,  378,  378,  378,  378,  378,  378,  378,  378,
+      378,  378,  378,  378,  378,  378,  378,  378,  378,  378,
+      378,  378,  378,  378,  378,  378,  378,  378,  378,  378,
+      378,  378,  378,  378,  378,  378,  378,  378,  378,  378,
+      378,  378,  378,  378,  378,  378,  378,  378,  378,  378
     } ;
 
-static const flex_int16_t yy_chk[435] =
+static const flex_int16_t yy_chk[781] =
     {   0,
+        0,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    1,    1,    1,    1,    1,    1,    1,    1,    5,
-      300,    5,   14,   14,   14,   14,   16,   17,   17,   17,
-       17,   16,   24,   16,   16,   16,   16,   16,   23,   25,
-       16,   16,   16,   27,   28,   24,   23,   25,   33,   25,
-       83,   83,   16,   27,   23,   32,   33,   28,   36,   16,
-       28,   35,   16,   35,   32,   37,   42,   38,   42,   37,
-
-       36,   38,   39,   37,   38,   38,   39,   89,   57,   89,
-       38,   39,   38,  299,   39,  298,   38,   46,   48,   48,
-       48,   48,   57,   61,   46,   46,   46,   46,   61,  122,
-      122,   46,   46,   46,   50,   50,   50,   50,   54,   54,
-       54,   54,   78,   46,   93,   84,   84,  296,   78,  294,
-       46,   84,   84,   46,  155,  155,   93,  114,   78,  104,
-      104,  104,  104,  114,  140,  140,  140,  293,  173,  114,
-      161,  161,  161,  173,  175,  175,  179,  179,  179,  140,
-      190,  234,  234,  234,  190,  212,  212,  212,  212,  237,
-      237,  237,  251,  251,  251,  252,  252,  253,  253,  253,
-
-      253,  306,  306,  306,  306,  307,  277,  307,  307,  307,
-      307,  307,  308,  308,  308,  309,  309,  309,  310,  274,
-      272,  310,  311,  263,  262,  311,  312,  260,  259,  312,
-      313,  313,  313,  314,  314,  314,  315,  315,  315,  316,
-      257,  255,  316,  316,  317,  317,  317,  254,  249,  247,
-      244,  243,  242,  241,  240,  239,  235,  232,  231,  230,
-      226,  223,  222,  220,  219,  217,  213,  210,  205,  204,
-      203,  202,  200,  199,  198,  197,  196,  192,  191,  189,
-      188,  187,  186,  185,  184,  183,  182,  181,  178,  170,
-      167,  166,  164,  163,  160,  159,  157,  156,  153,  152,
-
-      151,  150,  149,  148,  147,  146,  145,  142,  141,  139,
-      138,  137,  136,  135,  134,  133,  131,  130,  129,  127,
-      126,  125,  124,  123,  121,  120,  119,  118,  116,  115,
-      113,  112,  111,  109,  108,  107,  106,  101,   98,   97,
-       96,   94,   92,   91,   90,   88,   87,   86,   85,   82,
-       81,   80,   79,   77,   76,   75,   74,   73,   72,   71,
-       70,   69,   68,   67,   66,   65,   64,   63,   62,   60,
-       59,   58,   51,   43,   41,   40,   34,   31,   30,   29,
-       26,   20,    9,    3,  305,  305,  305,  305,  305,  305,
-      305,  305,  305,  305,  305,  305,  305,  305,  305,  305,
-
-      305,  305,  305,  305,  305,  305,  305,  305,  305,  305,
-      305,  305,  305,  305,  305,  305,  305,  305,  305,  305,
-      305,  305,  305,  305,  305,  305,  305,  305,  305,  305,
-      305,  305,  305,  305
+        1,    5,    7,    5,    7,    9,   23,    7,    7,    7,
+        7,   26,   28,    7,    7,    7,    7,    7,    7,    7,
+        7,    7,    7,    7,    7,    7,    7,    7,    7,    7,
+        7,    7,    7,    7,    7,    7,    7,    7,    7,    7,
+        7,    7,    7,    7,    8,    8,   29,    8,    8,    8,
+        8,    8,    8,    8,    8,    8,    8,    8,    8,    8,
+        8,    8,    8,    8,    8,    8,    8,    8,    8,    8,
+        8,    8,    8,    8,    8,    8,    8,    8,    8,    8,
+        8,    8,    8,    8,    8,    8,    8,    8,    8,    8,
+        8,    8,    8,    8,   14,   14,   14,   14,   16,   17,
+       17,   17,   17,   16,   27,   16,   16,   16,   16,   16,
+       20,   24,   16,   16,   16,   22,   32,   21,   20,   39,
+       27,   24,   22,   22,   16,   22,   20,   21,   22,   40,
+       21,   16,   31,   21,   16,   19,   19,   19,   19,   41,
+       31,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   25,   30,   52,   33,   34,   47,   51,   53,
+       25,   55,   30,   34,   34,   25,   36,   33,   25,   33,
+       36,   57,   51,   37,   36,   34,   54,   37,   54,   36,
+       37,   37,   56,   47,   58,   38,   37,   56,   37,   38,
+       43,   37,   37,   38,   46,   46,   46,   46,   38,   59,
+       60,   38,   61,   62,   43,   43,   43,   63,   64,   65,
+       66,   67,   68,   69,   70,   71,   43,   73,   74,   75,
+       76,   77,   78,   43,   79,   80,   43,   81,   76,   82,
+       79,   83,   84,   85,   86,   89,   79,   87,   87,   90,
+       79,   88,   88,   91,   92,   93,   95,   88,   88,   94,
+       96,   94,   97,   98,   99,   92,  100,  101,  103,  104,
+      105,  113,  114,   94,  106,  106,  106,  106,  100,  115,
+      106,  106,  106,  106,  106,  106,  106,  106,  106,  106,
+      106,  106,  106,  106,  106,  106,  106,  106,  106,  106,
+      106,  106,  106,  106,  106,  106,  106,  106,  106,  106,
+      106,  108,  111,  111,  111,  111,  116,  118,  119,  120,
+      121,  122,  123,  124,  125,  126,  127,  128,  130,  131,
+      125,  132,  133,  134,  135,  135,  125,  108,  136,  137,
+      138,  139,  140,  141,  142,  144,  145,  146,  147,  148,
+      150,  151,  152,  153,  154,  155,  156,  157,  158,  159,
+      159,  159,  160,  161,  162,  164,  166,  167,  168,  169,
+      170,  171,  172,  173,  159,  175,  176,  177,  179,  179,
+      180,  181,  183,  184,  185,  185,  185,  187,  188,  190,
+      188,  192,  193,  194,  195,  198,  199,  202,  203,  205,
+      205,  208,  202,  209,  210,  210,  210,  212,  213,  214,
+      215,  216,  217,  218,  219,  220,  221,  222,  224,  225,
+      226,  227,  228,  232,  226,  233,  234,  237,  238,  241,
+      242,  243,  244,  245,  250,  252,  252,  252,  252,  253,
+      257,  258,  259,  264,  266,  267,  268,  269,  244,  244,
+      244,  244,  244,  272,  244,  244,  244,  244,  244,  244,
+      244,  244,  244,  244,  244,  244,  244,  244,  244,  244,
+      244,  244,  244,  244,  244,  244,  244,  244,  244,  262,
+      273,  278,  279,  280,  282,  283,  283,  283,  284,  285,
+      286,  288,  288,  288,  290,  262,  262,  262,  262,  262,
+      291,  262,  262,  262,  262,  262,  262,  262,  262,  262,
+      262,  262,  262,  262,  262,  262,  262,  262,  262,  262,
+      262,  262,  262,  262,  262,  262,  277,  292,  293,  294,
+      295,  298,  300,  301,  303,  303,  303,  304,  304,  306,
+      307,  308,  277,  277,  277,  277,  277,  309,  277,  277,
+      277,  277,  277,  277,  277,  277,  277,  277,  277,  277,
+      277,  277,  277,  277,  277,  277,  277,  277,  277,  277,
+      277,  277,  277,  302,  305,  305,  305,  305,  310,  311,
+      312,  314,  316,  302,  302,  302,  302,  317,  310,  310,
+      310,  310,  318,  319,  302,  320,  321,  322,  328,  310,
+      333,  335,  318,  318,  318,  318,  338,  349,  350,  352,
+      354,  357,  358,  318,  359,  362,  364,  368,  369,  370,
+      371,  375,  376,    0,    0,    0,    0,    0,    0,    0,
+        0,    0,  376,  376,  376,  376,  371,  371,  371,  371,
+      371,  371,  371,  371,  371,  371,  371,  371,  371,  371,
+      371,  371,  371,  371,  371,  371,  371,  371,  371,  371,
+      371,  371,  371,  371,  371,  371,  371,    0,    0,  378,
+      378,  378,  378,  378,  378,  378,  378,  378,  378,  378,
+      378,  378,  378,  378,  378,  378,  378,  378,  378,  378,
+      378,  378,  378,  378,  378,  378,  378,  378,  378,  378,
+      378,  378,  378,  378,  378,  378,  378,  378,  378,  378,
+      378,  378,  378,  378,  378,  378,  378,  378,  378,  378
     } ;
 
 static yy_state_type yy_last_accepting_state;
@@ -641,8 +709,8 @@ char *yytext;
 int endOfFile (void);
 
 /* recognize the keywords */
-#line 645 "lex.yy.c"
-#line 646 "lex.yy.c"
+#line 713 "lex.yy.c"
+#line 714 "lex.yy.c"
 
 #define INITIAL 0
 
@@ -861,7 +929,7 @@ YY_DECL
 	{
 #line 9 "easy2.l"
 
-#line 865 "lex.yy.c"
+#line 933 "lex.yy.c"
 
 	while ( /*CONSTCOND*/1 )		/* loops until end-of-file is reached */
 		{
@@ -888,13 +956,13 @@ yy_match:
 			while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 				{
 				yy_current_state = (int) yy_def[yy_current_state];
-				if ( yy_current_state >= 306 )
+				if ( yy_current_state >= 379 )
 					yy_c = yy_meta[yy_c];
 				}
 			yy_current_state = yy_nxt[yy_base[yy_current_state] + yy_c];
 			++yy_cp;
 			}
-		while ( yy_base[yy_current_state] != 385 );
+		while ( yy_base[yy_current_state] != 730 );
 
 yy_find_action:
 		yy_act = yy_accept[yy_current_state];
@@ -1003,459 +1071,564 @@ YY_RULE_SETUP
 #line 38 "easy2.l"
 {push(VOL3,0,NULL); }
 	YY_BREAK
-/* these keywords actually do stuff with output signal */
 case 17:
 YY_RULE_SETUP
-#line 42 "easy2.l"
-{push(OUTPUT,0,NULL); }
+#line 39 "easy2.l"
+{push(PARTIAL,0,NULL); }
 	YY_BREAK
 case 18:
 YY_RULE_SETUP
+#line 40 "easy2.l"
+{push(HZ,0,NULL); }
+	YY_BREAK
+case 19:
+YY_RULE_SETUP
+#line 41 "easy2.l"
+{push(OFFSET,0,NULL); }
+	YY_BREAK
+case 20:
+YY_RULE_SETUP
+#line 42 "easy2.l"
+{push(CHORD,0,NULL); }
+	YY_BREAK
+case 21:
+YY_RULE_SETUP
 #line 43 "easy2.l"
+{push(NOPARTIALS,0,NULL); }
+	YY_BREAK
+/* these keywords actually do stuff with output signal */
+case 22:
+YY_RULE_SETUP
+#line 47 "easy2.l"
+{push(OUTPUT,0,NULL); }
+	YY_BREAK
+case 23:
+YY_RULE_SETUP
+#line 48 "easy2.l"
 {push(INCLUDE,0,NULL); }
 	YY_BREAK
-case 19:
+case 24:
 YY_RULE_SETUP
-#line 44 "easy2.l"
+#line 49 "easy2.l"
 {push(MIX,0,NULL); }
 	YY_BREAK
-case 20:
+case 25:
 YY_RULE_SETUP
-#line 45 "easy2.l"
+#line 50 "easy2.l"
 {push(SOUND,0,NULL); }
 	YY_BREAK
-case 21:
+case 26:
 YY_RULE_SETUP
-#line 46 "easy2.l"
+#line 51 "easy2.l"
 {push(SILENCE,0,NULL); }
 	YY_BREAK
 /* after effects - things that modify an output signal */
-case 22:
+case 27:
 YY_RULE_SETUP
-#line 50 "easy2.l"
+#line 55 "easy2.l"
 {push(BOOST,0,NULL); }
 	YY_BREAK
-case 23:
+case 28:
 YY_RULE_SETUP
-#line 51 "easy2.l"
+#line 56 "easy2.l"
 {push(BOOST,0,NULL); }  
 	YY_BREAK
-case 24:
+case 29:
 YY_RULE_SETUP
-#line 52 "easy2.l"
+#line 57 "easy2.l"
 {push(REVERB,0,NULL); }
 	YY_BREAK
+case 30:
+YY_RULE_SETUP
+#line 58 "easy2.l"
+{push(TAP,0,NULL); }
+	YY_BREAK
+case 31:
+YY_RULE_SETUP
+#line 59 "easy2.l"
+{push(CONVOLVE,0,NULL); }
+	YY_BREAK
+case 32:
+YY_RULE_SETUP
+#line 60 "easy2.l"
+{push(ROOM,0,NULL); }
+	YY_BREAK
+case 33:
+YY_RULE_SETUP
+#line 61 "easy2.l"
+{push(SIZE,0,NULL); }
+	YY_BREAK
+case 34:
+YY_RULE_SETUP
+#line 62 "easy2.l"
+{push(FILTER,0,NULL); }
+	YY_BREAK
+case 35:
+YY_RULE_SETUP
+#line 63 "easy2.l"
+{push(LOWPASS,0,NULL); }
+	YY_BREAK
+case 36:
+YY_RULE_SETUP
+#line 64 "easy2.l"
+{push(HIGHPASS,0,NULL); }
+	YY_BREAK
+case 37:
+YY_RULE_SETUP
+#line 65 "easy2.l"
+{push(BANDPASS,0,NULL); }
+	YY_BREAK
+case 38:
+YY_RULE_SETUP
+#line 66 "easy2.l"
+{push(NOTCH,0,NULL); }
+	YY_BREAK
+case 39:
+YY_RULE_SETUP
+#line 67 "easy2.l"
+{push(Q,0,NULL); }
+	YY_BREAK
+case 40:
+YY_RULE_SETUP
+#line 68 "easy2.l"
+{push(STAGES,0,NULL); }
+	YY_BREAK
 /* these commands modify the master time */
-case 25:
+case 41:
 YY_RULE_SETUP
-#line 56 "easy2.l"
+#line 72 "easy2.l"
 {push(TIME,0,NULL); }
 	YY_BREAK
-case 26:
+case 42:
 YY_RULE_SETUP
-#line 57 "easy2.l"
+#line 73 "easy2.l"
 {push(ADDTIME,0,NULL); }
 	YY_BREAK
-case 27:
+case 43:
 YY_RULE_SETUP
-#line 58 "easy2.l"
+#line 74 "easy2.l"
 {push(REWIND,0,NULL); }
 	YY_BREAK
 /* simple settings keywords: each takes one or more constants or keywords */
-case 28:
+case 44:
 YY_RULE_SETUP
-#line 62 "easy2.l"
+#line 78 "easy2.l"
 {push(AUTOMIX,0,NULL); }
 	YY_BREAK
-case 29:
+case 45:
 YY_RULE_SETUP
-#line 63 "easy2.l"
+#line 79 "easy2.l"
 {push(MANUALMIX,0,NULL); }
 	YY_BREAK
-case 30:
+case 46:
 YY_RULE_SETUP
-#line 64 "easy2.l"
+#line 80 "easy2.l"
 {push(FADEIN,0,NULL); }
 	YY_BREAK
-case 31:
+case 47:
 YY_RULE_SETUP
-#line 65 "easy2.l"
+#line 81 "easy2.l"
 {push(FADEOUT,0,NULL); }
 	YY_BREAK
-case 32:
+case 48:
 YY_RULE_SETUP
-#line 66 "easy2.l"
+#line 82 "easy2.l"
 {push(DUTY,0,NULL); }
 	YY_BREAK
-case 33:
+case 49:
 YY_RULE_SETUP
-#line 67 "easy2.l"
+#line 83 "easy2.l"
 {push(SHAPE,0,NULL); }
 	YY_BREAK
-case 34:
+case 50:
 YY_RULE_SETUP
-#line 68 "easy2.l"
+#line 84 "easy2.l"
 {push(FORM,0,NULL); }
 	YY_BREAK
-case 35:
+case 51:
 YY_RULE_SETUP
-#line 69 "easy2.l"
+#line 85 "easy2.l"
 {push(CIRCUIT,0,NULL); }
 	YY_BREAK
-case 36:
+case 52:
 YY_RULE_SETUP
-#line 70 "easy2.l"
+#line 86 "easy2.l"
 {push(NOCIRCUIT,0,NULL); }
 	YY_BREAK
+case 53:
+YY_RULE_SETUP
+#line 87 "easy2.l"
+{push(SEED,0,NULL); }
+	YY_BREAK
 /* these keywords create NumberDrivers */
-case 37:
+case 54:
 YY_RULE_SETUP
-#line 74 "easy2.l"
+#line 91 "easy2.l"
 {push(OSC,0,NULL); }
 	YY_BREAK
-case 38:
+case 55:
 YY_RULE_SETUP
-#line 75 "easy2.l"
+#line 92 "easy2.l"
 {push(RANDSEQ,0,NULL); }
 	YY_BREAK
-case 39:
+case 56:
 YY_RULE_SETUP
-#line 76 "easy2.l"
+#line 93 "easy2.l"
 {push(RANDOM,0,NULL); }
 	YY_BREAK
-case 40:
+case 57:
 YY_RULE_SETUP
-#line 77 "easy2.l"
+#line 94 "easy2.l"
 {push(RAMP,0,NULL); }
 	YY_BREAK
-case 41:
+case 58:
 YY_RULE_SETUP
-#line 78 "easy2.l"
+#line 95 "easy2.l"
 {push(SEQ,0,NULL); }
 	YY_BREAK
-case 42:
+case 59:
 YY_RULE_SETUP
-#line 79 "easy2.l"
+#line 96 "easy2.l"
 {push(RAMPS,0,NULL); }
 	YY_BREAK
-case 43:
+case 60:
 YY_RULE_SETUP
-#line 80 "easy2.l"
+#line 97 "easy2.l"
 {push(CIRP,0,NULL); }
 	YY_BREAK
-case 44:
+case 61:
 YY_RULE_SETUP
-#line 81 "easy2.l"
+#line 98 "easy2.l"
 {push(CIRI,0,NULL); }
 	YY_BREAK
 /* simple args */
-case 45:
+case 62:
 YY_RULE_SETUP
-#line 85 "easy2.l"
+#line 102 "easy2.l"
 {push(WF_SINE,0,NULL); }
 	YY_BREAK
-case 46:
+case 63:
 YY_RULE_SETUP
-#line 86 "easy2.l"
+#line 103 "easy2.l"
 {push(WF_SQUARE,0,NULL); }
 	YY_BREAK
-case 47:
+case 64:
 YY_RULE_SETUP
-#line 87 "easy2.l"
+#line 104 "easy2.l"
 {push(WF_SAW,0,NULL); }
 	YY_BREAK
-case 48:
+case 65:
 YY_RULE_SETUP
-#line 88 "easy2.l"
+#line 105 "easy2.l"
 {push(WF_TRI,0,NULL); }
 	YY_BREAK
-case 49:
+case 66:
 YY_RULE_SETUP
-#line 89 "easy2.l"
+#line 106 "easy2.l"
 {push(WF_TENS,0,NULL); }
 	YY_BREAK
-case 50:
+case 67:
 YY_RULE_SETUP
-#line 90 "easy2.l"
+#line 107 "easy2.l"
 {push(WF_NOISE,0,NULL); }
 	YY_BREAK
+case 68:
+YY_RULE_SETUP
+#line 108 "easy2.l"
+{push(WF_PINK,0,NULL); }
+	YY_BREAK
+case 69:
+YY_RULE_SETUP
+#line 109 "easy2.l"
+{push(WF_BROWN,0,NULL); }
+	YY_BREAK
+case 70:
+YY_RULE_SETUP
+#line 110 "easy2.l"
+{push(WF_BANDNOISE,0,NULL); }
+	YY_BREAK
+case 71:
+YY_RULE_SETUP
+#line 111 "easy2.l"
+{push(BLEP,0,NULL); }
+	YY_BREAK
 /* sound shapes */
-case 51:
+case 72:
 YY_RULE_SETUP
-#line 95 "easy2.l"
+#line 116 "easy2.l"
 {push(SH_TEASE1,0,NULL); }
 	YY_BREAK
-case 52:
+case 73:
 YY_RULE_SETUP
-#line 96 "easy2.l"
+#line 117 "easy2.l"
 {push(SH_TEASE2,0,NULL); }
 	YY_BREAK
-case 53:
+case 74:
 YY_RULE_SETUP
-#line 97 "easy2.l"
+#line 118 "easy2.l"
 {push(SH_TEASE3,0,NULL); }
 	YY_BREAK
-case 54:
+case 75:
 YY_RULE_SETUP
-#line 98 "easy2.l"
+#line 119 "easy2.l"
 {push(SH_PULSE1,0,NULL); }
 	YY_BREAK
-case 55:
+case 76:
 YY_RULE_SETUP
-#line 99 "easy2.l"
+#line 120 "easy2.l"
 {push(SH_PULSE2,0,NULL); }
 	YY_BREAK
-case 56:
+case 77:
 YY_RULE_SETUP
-#line 100 "easy2.l"
+#line 121 "easy2.l"
 {push(SH_PULSE3,0,NULL); }
 	YY_BREAK
-case 57:
+case 78:
 YY_RULE_SETUP
-#line 101 "easy2.l"
+#line 122 "easy2.l"
 {push(SH_KICK1,0,NULL); }
 	YY_BREAK
-case 58:
+case 79:
 YY_RULE_SETUP
-#line 102 "easy2.l"
+#line 123 "easy2.l"
 {push(SH_KICK2,0,NULL); }
 	YY_BREAK
-case 59:
+case 80:
 YY_RULE_SETUP
-#line 103 "easy2.l"
+#line 124 "easy2.l"
 {push(SH_KICK3,0,NULL); }
 	YY_BREAK
-case 60:
+case 81:
 YY_RULE_SETUP
-#line 104 "easy2.l"
+#line 125 "easy2.l"
 {push(SH_NOTCH1,0,NULL); }
 	YY_BREAK
-case 61:
+case 82:
 YY_RULE_SETUP
-#line 105 "easy2.l"
+#line 126 "easy2.l"
 {push(SH_NOTCH2,0,NULL); }
 	YY_BREAK
-case 62:
+case 83:
 YY_RULE_SETUP
-#line 106 "easy2.l"
+#line 127 "easy2.l"
 {push(SH_NOTCH3,0,NULL); }
 	YY_BREAK
-case 63:
+case 84:
 YY_RULE_SETUP
-#line 107 "easy2.l"
+#line 128 "easy2.l"
 {push(SH_ADSR1,0,NULL); }
 	YY_BREAK
-case 64:
+case 85:
 YY_RULE_SETUP
-#line 108 "easy2.l"
+#line 129 "easy2.l"
 {push(SH_ADSR2,0,NULL); }
 	YY_BREAK
-case 65:
+case 86:
 YY_RULE_SETUP
-#line 109 "easy2.l"
+#line 130 "easy2.l"
 {push(SH_ADSR3,0,NULL); }
 	YY_BREAK
-case 66:
+case 87:
 YY_RULE_SETUP
-#line 110 "easy2.l"
+#line 131 "easy2.l"
 {push(SH_REV1,0,NULL); }
 	YY_BREAK
-case 67:
+case 88:
 YY_RULE_SETUP
-#line 111 "easy2.l"
+#line 132 "easy2.l"
 {push(SH_REV2,0,NULL); }
 	YY_BREAK
-case 68:
+case 89:
 YY_RULE_SETUP
-#line 112 "easy2.l"
+#line 133 "easy2.l"
 {push(SH_REV3,0,NULL); }
 	YY_BREAK
-case 69:
+case 90:
 YY_RULE_SETUP
-#line 113 "easy2.l"
+#line 134 "easy2.l"
 {push(SH_WEDGE1,0,NULL); }
 	YY_BREAK
-case 70:
+case 91:
 YY_RULE_SETUP
-#line 114 "easy2.l"
+#line 135 "easy2.l"
 {push(SH_WEDGE2,0,NULL); }
 	YY_BREAK
-case 71:
+case 92:
 YY_RULE_SETUP
-#line 115 "easy2.l"
+#line 136 "easy2.l"
 {push(SH_GAP1,0,NULL); }
 	YY_BREAK
-case 72:
+case 93:
 YY_RULE_SETUP
-#line 116 "easy2.l"
+#line 137 "easy2.l"
 {push(SH_GAP2,0,NULL); }
 	YY_BREAK
 /* flow control */
-case 73:
+case 94:
 YY_RULE_SETUP
-#line 120 "easy2.l"
+#line 141 "easy2.l"
 {push(REPEAT,0,NULL); }
 	YY_BREAK
-case 74:
+case 95:
 YY_RULE_SETUP
-#line 121 "easy2.l"
+#line 142 "easy2.l"
 {push(LOOP,0,loopvar(strdup(yytext))); }
 	YY_BREAK
-case 75:
+case 96:
 YY_RULE_SETUP
-#line 122 "easy2.l"
+#line 143 "easy2.l"
 {push(EXIT,0,NULL); }
 	YY_BREAK
-case 76:
+case 97:
 YY_RULE_SETUP
-#line 123 "easy2.l"
+#line 144 "easy2.l"
 {push(CLEAR,0,NULL);}
 	YY_BREAK
 /* subroutines */
-case 77:
+case 98:
 YY_RULE_SETUP
-#line 126 "easy2.l"
+#line 147 "easy2.l"
 {declareSub(strdup(yytext));}
 	YY_BREAK
-case 78:
+case 99:
 YY_RULE_SETUP
-#line 127 "easy2.l"
+#line 148 "easy2.l"
 {endSubC();}
 	YY_BREAK
-case 79:
+case 100:
 YY_RULE_SETUP
-#line 128 "easy2.l"
+#line 149 "easy2.l"
 {callSub(strdup(yytext));}
 	YY_BREAK
-case 80:
+case 101:
 YY_RULE_SETUP
-#line 129 "easy2.l"
+#line 150 "easy2.l"
 {push(REQUIRE,0,strdup(yytext));}
 	YY_BREAK
 /* time stamps */
-case 81:
+case 102:
 YY_RULE_SETUP
-#line 133 "easy2.l"
+#line 154 "easy2.l"
 {push(TIMESTAMP,0,yytext); }   // h:mm:ss
 	YY_BREAK
-case 82:
+case 103:
 YY_RULE_SETUP
-#line 134 "easy2.l"
+#line 155 "easy2.l"
 {push(TIMESTAMP,0,yytext); }   // m:ss
 	YY_BREAK
-case 83:
+case 104:
 YY_RULE_SETUP
-#line 135 "easy2.l"
+#line 156 "easy2.l"
 {push(TIMESTAMP,0,(yytext)); }   // :ss
 	YY_BREAK
 /* ignore colon otherwise */
-case 84:
+case 105:
 YY_RULE_SETUP
-#line 139 "easy2.l"
+#line 160 "easy2.l"
 { }
 	YY_BREAK
 /* math operators */
-case 85:
+case 106:
 YY_RULE_SETUP
-#line 143 "easy2.l"
+#line 164 "easy2.l"
 {push(PLUS,0,NULL); }
 	YY_BREAK
-case 86:
+case 107:
 YY_RULE_SETUP
-#line 144 "easy2.l"
+#line 165 "easy2.l"
 {push(MINUS,0,NULL);}
 	YY_BREAK
-case 87:
+case 108:
 YY_RULE_SETUP
-#line 145 "easy2.l"
+#line 166 "easy2.l"
 {push(MULT,0,NULL);}
 	YY_BREAK
-case 88:
+case 109:
 YY_RULE_SETUP
-#line 146 "easy2.l"
+#line 167 "easy2.l"
 {push(DIV,0,NULL);}
 	YY_BREAK
-case 89:
+case 110:
 YY_RULE_SETUP
-#line 147 "easy2.l"
+#line 168 "easy2.l"
 {push(MODULUS,0,NULL);}
 	YY_BREAK
-case 90:
+case 111:
 YY_RULE_SETUP
-#line 150 "easy2.l"
+#line 171 "easy2.l"
 {push(ASSIGNMENT,0,NULL); } 
 	YY_BREAK
-case 91:
+case 112:
 YY_RULE_SETUP
-#line 152 "easy2.l"
+#line 173 "easy2.l"
 {push(FILENAME,0,(char *) doFilename(yytext)); }
 	YY_BREAK
-case 92:
+case 113:
 YY_RULE_SETUP
-#line 154 "easy2.l"
+#line 175 "easy2.l"
 {push(STRING,NO_NUMBER,strdup(yytext)); } 
 	YY_BREAK
 /* note that negative and positive are handled above in plus/minus */
-case 93:
+case 114:
 YY_RULE_SETUP
-#line 158 "easy2.l"
+#line 179 "easy2.l"
 {push(NUMBER,atof(yytext),NULL); }  // without decimal...
 	YY_BREAK
-case 94:
+case 115:
 YY_RULE_SETUP
-#line 159 "easy2.l"
+#line 180 "easy2.l"
 {numberhz(yytext); }    // freq in Hertz
 	YY_BREAK
-case 95:
+case 116:
 YY_RULE_SETUP
-#line 160 "easy2.l"
+#line 181 "easy2.l"
 {numberPeriod(yytext); }    // period in sec
 	YY_BREAK
-case 96:
+case 117:
 YY_RULE_SETUP
-#line 161 "easy2.l"
+#line 182 "easy2.l"
 {numbers(yytext); }     // amount in seconds
 	YY_BREAK
-case 97:
+case 118:
 YY_RULE_SETUP
-#line 162 "easy2.l"
+#line 183 "easy2.l"
 {numberpct(yytext); }  // percentage
 	YY_BREAK
-case 98:
+case 119:
 YY_RULE_SETUP
-#line 163 "easy2.l"
+#line 184 "easy2.l"
 {push(NUMBER,atof(yytext),NULL); }  // with decimal...
 	YY_BREAK
-case 99:
+case 120:
 YY_RULE_SETUP
-#line 164 "easy2.l"
+#line 185 "easy2.l"
 {numberhz(yytext); }  // freq in Hertz
 	YY_BREAK
-case 100:
+case 121:
 YY_RULE_SETUP
-#line 165 "easy2.l"
+#line 186 "easy2.l"
 {numbers(yytext); }  // amount in seconds
 	YY_BREAK
-case 101:
+case 122:
 YY_RULE_SETUP
-#line 166 "easy2.l"
+#line 187 "easy2.l"
 {numberPeriod(yytext); }  // period seconds
 	YY_BREAK
-case 102:
+case 123:
 YY_RULE_SETUP
-#line 167 "easy2.l"
+#line 188 "easy2.l"
 {numberpct(yytext); }  // percentage
 	YY_BREAK
 case YY_STATE_EOF(INITIAL):
-#line 169 "easy2.l"
+#line 190 "easy2.l"
 {endOfFile();}
 	YY_BREAK
-case 103:
+case 124:
 YY_RULE_SETUP
-#line 171 "easy2.l"
+#line 192 "easy2.l"
 ECHO;
 	YY_BREAK
-#line 1459 "lex.yy.c"
+#line 1632 "lex.yy.c"
 
 	case YY_END_OF_BUFFER:
 		{
@@ -1750,7 +1923,7 @@ static int yy_get_next_buffer (void)
 		while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 			{
 			yy_current_state = (int) yy_def[yy_current_state];
-			if ( yy_current_state >= 306 )
+			if ( yy_current_state >= 379 )
 				yy_c = yy_meta[yy_c];
 			}
 		yy_current_state = yy_nxt[yy_base[yy_current_state] + yy_c];
@@ -1778,11 +1951,11 @@ static int yy_get_next_buffer (void)
 	while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 		{
 		yy_current_state = (int) yy_def[yy_current_state];
-		if ( yy_current_state >= 306 )
+		if ( yy_current_state >= 379 )
 			yy_c = yy_meta[yy_c];
 		}
 	yy_current_state = yy_nxt[yy_base[yy_current_state] + yy_c];
-	yy_is_jam = (yy_current_state == 305);
+	yy_is_jam = (yy_current_state == 378);
 
 		return yy_is_jam ? 0 : yy_current_state;
 }
@@ -2466,6 +2639,11 @@ extern char * originalinfile;
 
 int flag48=1;
 int subBlock=0;
+int flagJobs=1;       /* worker threads for doSound, -j */
+int flagGraph=0;      /* run independent commands together, -g */
+int flagStream=0;     /* seconds kept in memory when streaming, -s */
+int flagMap=0;        /* write the output through a memory map, -m */
+int flagInterleave=0; /* keep L and R together in memory, -i */
 
 /*======================================================================*/
 
@@ -2484,6 +2662,31 @@ int main(int argc, char * argv[]) {
       else if (strcmp(argv[i],"-44")==0) {
         flag48=0;
       }
+      else if (strcmp(argv[i],"-j")==0) {
+        if ((i+1>=argc) || (atoi(argv[i+1])<1)) {
+          printf ("\n%sERROR: -j needs a number of threads\n\n%s",RED,WHT);
+          return -1;
+        }
+        i++;
+        flagJobs=atoi(argv[i]);
+      }
+      else if (strcmp(argv[i],"-g")==0) {
+        flagGraph=1;
+      }
+      else if (strcmp(argv[i],"-s")==0) {
+        if ((i+1>=argc) || (atoi(argv[i+1])<1)) {
+          printf ("\n%sERROR: -s needs a number of seconds\n\n%s",RED,WHT);
+          return -1;
+        }
+        i++;
+        flagStream=atoi(argv[i]);
+      }
+      else if (strcmp(argv[i],"-m")==0) {
+        flagMap=1;
+      }
+      else if (strcmp(argv[i],"-i")==0) {
+        flagInterleave=1;
+      }
       else {
         // open a file handle to a particular file:
 
@@ -2514,9 +2717,15 @@ int main(int argc, char * argv[]) {
 
   if (infile==NULL) {
     printf("%serror: need to provide a script filename to process.\n",RED);
-    printf("\n\nusage: %s [scriptfile] [-48]\n",argv[0]);
+    printf("\n\nusage: %s [scriptfile] [-48] [-j N] [-g] [-s N] [-m] [-i]\n",argv[0]);
     printf("           scriptfile is a .e2 set of commands\n");
-    printf("           48 sets output to 48kHz format\n%s",WHT);
+    printf("           48 sets output to 48kHz format\n");
+    printf("           j renders each sound on N threads\n");
+    printf("           g renders independent commands at the same time\n");
+    printf("           s writes the file as it goes, keeping N seconds back\n");
+    printf("           (rewind can then go back at most %d commands)\n",STREAM_REWIND);
+    printf("           m writes the file through a memory map\n");
+    printf("           i keeps the output interleaved (LRLR) in memory\n%s",WHT);
     exit(0);
   }
 